@@ -0,0 +1,320 @@
+#define VV_TRACK_GLOBAL_ALLOCATIONS
+#include "../include/alloc_tracking.hpp"
+#include "../include/vv0.hpp"
+#include "../include/vv1.hpp"
+#include "../include/vv3.hpp"
+#include "../include/vv3_hybrid.hpp"
+#include "../include/vv3_partitioned.hpp"
+#include "../include/vv3_rle.hpp"
+#include "../include/vv3_segmented.hpp"
+#include "../include/vv3_stream.hpp"
+#include "../include/vv4.hpp"
+#include <benchmark/benchmark.h>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <variant>
+#include <vector>
+
+// every design against the same type mixes, sizes and access patterns. besides
+// time each case reports, per iteration:
+//   bytes_per_elem  (heap held by the built container + its sizeof) / count
+//   allocs, frees   calls to operator new / operator delete
+//   peak_heap       highest heap use above where the iteration started
+// heap use is counted by the global operator new hook in alloc_tracking.hpp
+
+namespace bm = benchmark;
+
+struct BigType {
+  char c[5000];
+};
+
+// type mixes: the alternatives, and which one element i holds
+template <class... Ts> struct type_list {};
+
+constexpr std::size_t scramble(std::size_t i) {
+  return (i * 0x9E3779B97F4A7C15ull) >> 40;
+}
+
+struct small_mix {
+  static constexpr const char* name = "small";
+  using types = type_list<int, double, long long>;
+  static std::size_t kind(std::size_t i) { return scramble(i) % 3; }
+};
+
+struct align_mix {
+  static constexpr const char* name = "mixed_align";
+  using types = type_list<char, short, int, double>;
+  static std::size_t kind(std::size_t i) { return scramble(i) % 4; }
+};
+
+// one 5000 byte element in 64
+struct skewed_mix {
+  static constexpr const char* name = "skewed_big";
+  using types = type_list<int, long long, BigType>;
+  static std::size_t kind(std::size_t i) {
+    return scramble(i) % 64 == 0 ? 2 : scramble(i) % 2;
+  }
+};
+
+// calls f.template operator()<T>() for the index-th of Ts
+template <class... Ts, class F>
+void dispatch(type_list<Ts...>, std::size_t index, F&& f) {
+  std::size_t k = 0;
+  ((k++ == index ? (f.template operator()<Ts>(), true) : false) || ...);
+}
+
+template <class T> T make(std::size_t i) {
+  if constexpr (std::is_arithmetic_v<T>) {
+    return static_cast<T>(i);
+  } else {
+    return T{};
+  }
+}
+
+// implementations: a vector template plus typed get and an element walk that
+// hands over (tag, address)
+struct vv0_impl {
+  template <class... Ts> using vector = vv0::vector<Ts...>;
+
+  template <class T, class V> static T& get(V& v, std::size_t i) {
+    return std::get<T>(v[i]);
+  }
+
+  template <class List, class V, class F> static void walk(V& v, F&& f) {
+    for (auto& e : v) {
+      std::visit([&](auto& x) { f(e.index(), &x); }, e);
+    }
+  }
+};
+
+struct vv1_impl {
+  template <class... Ts> using vector = vv1::vector<Ts...>;
+
+  template <class T, class V> static T& get(V& v, std::size_t i) {
+    return v[i].template get<T>();
+  }
+
+  template <class List, class V, class F> static void walk(V& v, F&& f) {
+    for (auto& e : v) {
+      dispatch(List{}, e.index(),
+               [&]<class T>() { f(e.index(), &e.template get<T>()); });
+    }
+  }
+};
+
+template <template <class...> class Vec> struct vv3_impl {
+  template <class... Ts> using vector = Vec<Ts...>;
+
+  template <class T, class V> static T& get(V& v, std::size_t i) {
+    return v.template get<T>(i);
+  }
+
+  template <class List, class V, class F> static void walk(V& v, F&& f) {
+    for (auto e : v) {
+      f(e.type_index, e.data);
+    }
+  }
+};
+
+struct vv5_impl {
+  template <class... Ts> using vector = vv5::vector<Ts...>;
+
+  template <class T, class V> static T& get(V& v, std::size_t i) {
+    return v.template get<T>(i);
+  }
+
+  template <class List, class V, class F> static void walk(V& v, F&& f) {
+    for (std::size_t i = 0; i < v.size(); i++) {
+      auto e = v[i];
+      f(e.type_index, e.data);
+    }
+  }
+};
+
+template <class... Ts> using small_vector = vv3::small_vector<256, Ts...>;
+template <class... Ts> using segmented_vector =
+    vv3::segmented_vector<8192, Ts...>;
+template <class... Ts> using hybrid_vector = vv3::hybrid_vector<64, Ts...>;
+
+template <class Impl, class List> struct vector_for;
+
+template <class Impl, class... Ts> struct vector_for<Impl, type_list<Ts...>> {
+  using type = typename Impl::template vector<Ts...>;
+};
+
+template <class Impl, class Mix>
+using vector_t = typename vector_for<Impl, typename Mix::types>::type;
+
+template <class Impl, class Mix> vector_t<Impl, Mix> build(std::size_t n) {
+  vector_t<Impl, Mix> v;
+  for (std::size_t i = 0; i < n; i++) {
+    dispatch(typename Mix::types{}, Mix::kind(i),
+             [&]<class T>() { v.push_back(make<T>(i)); });
+  }
+  return v;
+}
+
+// heap activity summed over iterations
+struct tally {
+  std::size_t allocs = 0;
+  std::size_t frees = 0;
+  std::size_t peak = 0;
+
+  void add(const alloc_tracking::scope& s) {
+    allocs += s.allocations();
+    frees += s.deallocations();
+    peak = std::max(peak, s.peak_above());
+  }
+};
+
+// the vector object itself counts too, it's where small_vector keeps elements
+template <class V>
+void report(bm::State& state, std::size_t held, const tally& t) {
+  auto n = static_cast<double>(state.range(0));
+  state.counters["bytes_per_elem"] =
+      static_cast<double>(held + sizeof(V)) / n;
+  state.counters["allocs"] = bm::Counter(static_cast<double>(t.allocs),
+                                         bm::Counter::kAvgIterations);
+  state.counters["frees"] = bm::Counter(static_cast<double>(t.frees),
+                                        bm::Counter::kAvgIterations);
+  state.counters["peak_heap"] = static_cast<double>(t.peak);
+}
+
+template <class Impl, class Mix> void bench_append(bm::State& state) {
+  auto n = static_cast<std::size_t>(state.range(0));
+  std::size_t held = 0;
+  tally t;
+  for (auto _ : state) {
+    alloc_tracking::scope s;
+    auto v = build<Impl, Mix>(n);
+    bm::DoNotOptimize(v);
+    held = s.held();
+    t.add(s);
+  }
+  report<vector_t<Impl, Mix>>(state, held, t);
+}
+
+// reads elements in a scrambled order through the typed getter
+template <class Impl, class Mix> void bench_random_get(bm::State& state) {
+  auto n = static_cast<std::size_t>(state.range(0));
+  alloc_tracking::scope built;
+  auto v = build<Impl, Mix>(n);
+  std::size_t held = built.held();
+
+  std::vector<std::size_t> order(n);
+  for (std::size_t i = 0; i < n; i++) {
+    order[i] = scramble(i) % n;
+  }
+
+  tally t;
+  for (auto _ : state) {
+    alloc_tracking::scope s;
+    for (std::size_t i : order) {
+      dispatch(typename Mix::types{}, Mix::kind(i), [&]<class T>() {
+        bm::DoNotOptimize(&Impl::template get<T>(v, i));
+      });
+    }
+    t.add(s);
+  }
+  report<vector_t<Impl, Mix>>(state, held, t);
+}
+
+// front to back, touching every element's tag and first byte
+template <class Impl, class Mix> void bench_scan(bm::State& state) {
+  auto n = static_cast<std::size_t>(state.range(0));
+  alloc_tracking::scope built;
+  auto v = build<Impl, Mix>(n);
+  std::size_t held = built.held();
+
+  tally t;
+  for (auto _ : state) {
+    alloc_tracking::scope s;
+    std::size_t sum = 0;
+    Impl::template walk<typename Mix::types>(v, [&](std::size_t tag,
+                                                     const void* p) {
+      sum += tag + *static_cast<const unsigned char*>(p);
+    });
+    bm::DoNotOptimize(sum);
+    t.add(s);
+  }
+  report<vector_t<Impl, Mix>>(state, held, t);
+}
+
+template <class Impl, class Mix> void bench_copy(bm::State& state) {
+  auto n = static_cast<std::size_t>(state.range(0));
+  alloc_tracking::scope built;
+  auto v = build<Impl, Mix>(n);
+  std::size_t held = built.held();
+
+  tally t;
+  for (auto _ : state) {
+    alloc_tracking::scope s;
+    auto copy = v;
+    bm::DoNotOptimize(copy);
+    t.add(s);
+  }
+  report<vector_t<Impl, Mix>>(state, held, t);
+}
+
+// moves back and forth, so every iteration does the same work
+template <class Impl, class Mix> void bench_move(bm::State& state) {
+  auto n = static_cast<std::size_t>(state.range(0));
+  alloc_tracking::scope built;
+  auto v = build<Impl, Mix>(n);
+  std::size_t held = built.held();
+
+  tally t;
+  for (auto _ : state) {
+    alloc_tracking::scope s;
+    auto moved = std::move(v);
+    bm::DoNotOptimize(moved);
+    v = std::move(moved);
+    t.add(s);
+  }
+  report<vector_t<Impl, Mix>>(state, held, t);
+}
+
+template <class Impl, class Mix> void register_ops(const std::string& impl) {
+  std::string suffix = std::string("/") + Mix::name + "/" + impl;
+  std::pair<const char*, void (*)(bm::State&)> ops[]{
+      {"append", bench_append<Impl, Mix>},
+      {"random_get", bench_random_get<Impl, Mix>},
+      {"scan", bench_scan<Impl, Mix>},
+      {"copy", bench_copy<Impl, Mix>},
+      {"move", bench_move<Impl, Mix>},
+  };
+  for (auto [op, fn] : ops) {
+    bm::RegisterBenchmark((op + suffix).c_str(), fn)
+        ->Arg(1 << 10)
+        ->Arg(1 << 16)
+        ->Unit(bm::kMicrosecond);
+  }
+}
+
+template <class Mix> void register_mix() {
+  register_ops<vv0_impl, Mix>("vv0");
+  register_ops<vv1_impl, Mix>("vv1");
+  register_ops<vv3_impl<vv3::vector>, Mix>("vv3");
+  register_ops<vv3_impl<small_vector>, Mix>("vv3_small");
+  register_ops<vv3_impl<vv3::stream_vector>, Mix>("vv3_stream");
+  register_ops<vv3_impl<segmented_vector>, Mix>("vv3_segmented");
+  register_ops<vv3_impl<hybrid_vector>, Mix>("vv3_hybrid");
+  register_ops<vv3_impl<vv3::partitioned_vector>, Mix>("vv3_partitioned");
+  register_ops<vv3_impl<vv3::rle_vector>, Mix>("vv3_rle");
+  register_ops<vv5_impl, Mix>("vv5");
+}
+
+int main(int argc, char** argv) {
+  register_mix<small_mix>();
+  register_mix<align_mix>();
+  register_mix<skewed_mix>();
+
+  bm::Initialize(&argc, argv);
+  if (bm::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  bm::RunSpecifiedBenchmarks();
+  bm::Shutdown();
+  return 0;
+}
@@ -1,6 +1,8 @@
 #include "../include/vv3.hpp"
 #include <benchmark/benchmark.h>
+#include <cstdint>
 #include <cstdlib>
+#include <memory_resource>
 
 namespace bm = benchmark;
 using vv3::vector;
@@ -38,7 +40,179 @@ void bench_index(bm::State& state) {
   }
 }
 
+// get<T> latency at each offset width: the capacity reserved up front decides
+// whether offsets are stored in 1, 2 or 4 bytes (8 needs > 4 GiB of payload)
+void bench_index_offset_width(bm::State& state) {
+  constexpr std::size_t count = 30;
+  vector<int, long long> v;
+  v.reserve_cap(static_cast<std::size_t>(state.range(0)));
+  for (std::size_t i = 0; i < count; i++) {
+    v.push_back(static_cast<long long>(i));
+  }
+
+  for (auto _ : state) {
+    for (std::size_t i = 0; i < count; i++) {
+      bm::DoNotOptimize(v.get<long long>(i));
+    }
+  }
+
+  state.counters["offset_width"] = static_cast<double>(v.offset_width());
+  state.counters["meta_bytes_per_elem"] =
+      static_cast<double>(v.offset_width() + sizeof(decltype(v)::tag_type));
+}
+
+// request-scoped vectors: build a small vector and drop it, with the default
+// allocator vs a monotonic arena that is released once per batch
+void bench_build_drop_default(bm::State& state) {
+  for (auto _ : state) {
+    for (std::size_t i = 0; i < 100; i++) {
+      vector<int, double, long long> v;
+      for (int j = 0; j < 16; j++) {
+        v.push_back(j);
+        v.push_back(j * 0.5);
+      }
+      bm::DoNotOptimize(v);
+    }
+  }
+}
+
+void bench_build_drop_pmr(bm::State& state) {
+  std::byte buffer[1 << 16];
+  for (auto _ : state) {
+    std::pmr::monotonic_buffer_resource arena(buffer, sizeof(buffer));
+    for (std::size_t i = 0; i < 100; i++) {
+      vv3::pmr::vector<int, double, long long> v(&arena);
+      for (int j = 0; j < 16; j++) {
+        v.push_back(j);
+        v.push_back(j * 0.5);
+      }
+      bm::DoNotOptimize(v);
+    }
+  }
+}
+
+// full scans: indexed access reads tags and offsets, the iterator reads tags
+// and derives offsets from element sizes
+void bench_scan_index(bm::State& state) {
+  vector<int, double, long long> v;
+  for (std::size_t i = 0; i < num_iter; i++) {
+    if (i % 2 == 0) {
+      v.push_back(static_cast<int>(i));
+    } else {
+      v.push_back(static_cast<double>(i));
+    }
+  }
+
+  for (auto _ : state) {
+    std::size_t sum = 0;
+    for (std::size_t i = 0; i < v.size(); i++) {
+      auto e = v[i];
+      sum += e.type_index + static_cast<std::size_t>(*e.data);
+    }
+    bm::DoNotOptimize(sum);
+  }
+}
+
+void bench_scan_iterator(bm::State& state) {
+  vector<int, double, long long> v;
+  for (std::size_t i = 0; i < num_iter; i++) {
+    if (i % 2 == 0) {
+      v.push_back(static_cast<int>(i));
+    } else {
+      v.push_back(static_cast<double>(i));
+    }
+  }
+
+  for (auto _ : state) {
+    std::size_t sum = 0;
+    for (auto e : v) {
+      sum += e.type_index + static_cast<std::size_t>(*e.data);
+    }
+    bm::DoNotOptimize(sum);
+  }
+}
+
+// char/double interleaved: 7 bytes of padding per pair until compacted
+void bench_compact_by_alignment(bm::State& state) {
+  vector<char, double> src;
+  for (std::size_t i = 0; i < 4096; i++) {
+    src.push_back(static_cast<char>(i));
+    src.push_back(static_cast<double>(i));
+  }
+
+  std::size_t padding_after = 0;
+  for (auto _ : state) {
+    state.PauseTiming();
+    auto v = src;
+    state.ResumeTiming();
+    bm::DoNotOptimize(v.compact_by_alignment());
+    padding_after = v.padding_bytes();
+  }
+
+  state.counters["padding_before"] = static_cast<double>(src.padding_bytes());
+  state.counters["padding_after"] = static_cast<double>(padding_after);
+  state.counters["payload"] = static_cast<double>(src.payload_bytes());
+}
+
+// a batch whose shape is known up front: grown one push at a time vs sized
+// once with reserve_for
+void bench_batch_incremental(bm::State& state) {
+  for (auto _ : state) {
+    vector<int, double, long long> v;
+    for (int i = 0; i < 1000; i++) {
+      v.push_back(i);
+      v.push_back(i * 0.5);
+    }
+    bm::DoNotOptimize(v);
+  }
+}
+
+void bench_batch_reserve_for(bm::State& state) {
+  for (auto _ : state) {
+    vector<int, double, long long> v;
+    v.reserve_for<int, double>(1000, 1000);
+    for (int i = 0; i < 1000; i++) {
+      v.push_back(i);
+      v.push_back(i * 0.5);
+    }
+    bm::DoNotOptimize(v);
+  }
+}
+
+// get<int> with and without an offsets array: every alternative of the first
+// vector is 4 bytes, so element i sits at 4 * i; the uint16_t in the second
+// one makes it store (and pad for) offsets
+using same_stride = vector<int, float, std::uint32_t>;
+using mixed_stride = vector<int, float, std::uint16_t>;
+
+template <class Vector> void bench_index_stride(bm::State& state) {
+  Vector v;
+  for (std::size_t i = 0; i < num_iter; i++) {
+    v.push_back(static_cast<int>(i));
+  }
+
+  for (auto _ : state) {
+    int sum = 0;
+    for (std::size_t i = 0; i < num_iter; i++) {
+      sum += v.template get<int>(i);
+    }
+    bm::DoNotOptimize(sum);
+  }
+
+  state.counters["meta_bytes"] = static_cast<double>(v.metadata_bytes());
+}
+
 BENCHMARK(bench_pushback)->Unit(bm::kMillisecond);
 BENCHMARK(bench_index)->Unit(bm::kMillisecond);
+BENCHMARK(bench_index_offset_width)->Arg(256)->Arg(1 << 16)->Arg(1 << 20);
+BENCHMARK(bench_index_stride<same_stride>)->Unit(bm::kMicrosecond);
+BENCHMARK(bench_index_stride<mixed_stride>)->Unit(bm::kMicrosecond);
+BENCHMARK(bench_build_drop_default)->Unit(bm::kMicrosecond);
+BENCHMARK(bench_build_drop_pmr)->Unit(bm::kMicrosecond);
+BENCHMARK(bench_scan_index)->Unit(bm::kMicrosecond);
+BENCHMARK(bench_scan_iterator)->Unit(bm::kMicrosecond);
+BENCHMARK(bench_compact_by_alignment)->Unit(bm::kMicrosecond);
+BENCHMARK(bench_batch_incremental)->Unit(bm::kMicrosecond);
+BENCHMARK(bench_batch_reserve_for)->Unit(bm::kMicrosecond);
 BENCHMARK_MAIN();
 
@@ -0,0 +1,67 @@
+#include "../include/vv3.hpp"
+#include "../include/vv3_hybrid.hpp"
+#include <benchmark/benchmark.h>
+#include <memory_resource>
+
+namespace bm = benchmark;
+
+constexpr std::size_t num_iter = 2000;
+
+struct BigType {
+  char c[5000];
+};
+
+// one big element for every 16 small ones
+template <class Vector> void fill(Vector& v) {
+  for (std::size_t i = 0; i < num_iter; i++) {
+    if (i % 16 == 0) {
+      v.template emplace_back<BigType>();
+    } else {
+      v.push_back(static_cast<int>(i));
+    }
+  }
+}
+
+using inline_vec = vv3::vector<int, long long, BigType>;
+using hybrid_vec = vv3::hybrid_vector<64, int, long long, BigType>;
+
+template <class Vector> void bench_push_back(bm::State& state) {
+  for (auto _ : state) {
+    Vector v;
+    fill(v);
+    bm::DoNotOptimize(v);
+  }
+}
+
+void bench_push_back_hybrid_pool(bm::State& state) {
+  for (auto _ : state) {
+    std::pmr::unsynchronized_pool_resource pool;
+    vv3::pmr::hybrid_vector<64, int, long long, BigType> v(&pool);
+    fill(v);
+    bm::DoNotOptimize(v);
+  }
+}
+
+// sum the ints: with BigType inline every big element is ~5000 bytes of cache
+// misses between the small ones
+template <class Vector> void bench_scan_small(bm::State& state) {
+  Vector v;
+  fill(v);
+
+  for (auto _ : state) {
+    long long sum = 0;
+    for (auto e : v) {
+      if (e.type_index == 0) {
+        sum += *reinterpret_cast<int*>(e.data);
+      }
+    }
+    bm::DoNotOptimize(sum);
+  }
+}
+
+BENCHMARK(bench_push_back<inline_vec>)->Unit(bm::kMicrosecond);
+BENCHMARK(bench_push_back<hybrid_vec>)->Unit(bm::kMicrosecond);
+BENCHMARK(bench_push_back_hybrid_pool)->Unit(bm::kMicrosecond);
+BENCHMARK(bench_scan_small<inline_vec>)->Unit(bm::kMicrosecond);
+BENCHMARK(bench_scan_small<hybrid_vec>)->Unit(bm::kMicrosecond);
+BENCHMARK_MAIN();
@@ -0,0 +1,95 @@
+#include "../include/vv3.hpp"
+#include "../include/vv3_indexed.hpp"
+#include <benchmark/benchmark.h>
+#include <cstdlib>
+#include <string>
+
+namespace bm = benchmark;
+
+constexpr std::size_t num_iter = 5000;
+
+// strings are rare, so the index should win by roughly the match ratio
+template <class Vector> Vector make_sparse() {
+  Vector v;
+  std::srand(42);
+  for (std::size_t i = 0; i < num_iter; i++) {
+    int r = std::rand() % 32;
+    if (r == 0) {
+      v.push_back(std::string("needle"));
+    } else if (r % 2) {
+      v.push_back(static_cast<int>(i));
+    } else {
+      v.push_back(static_cast<double>(i));
+    }
+  }
+  return v;
+}
+
+using dense = vv3::vector<int, double, std::string>;
+using indexed = vv3::indexed_vector<int, double, std::string>;
+
+void bench_push_back_vv3(bm::State& state) {
+  for (auto _ : state) {
+    auto v = make_sparse<dense>();
+    bm::DoNotOptimize(v);
+  }
+}
+
+void bench_push_back_indexed(bm::State& state) {
+  for (auto _ : state) {
+    auto v = make_sparse<indexed>();
+    bm::DoNotOptimize(v);
+  }
+}
+
+void bench_count_scan_vv3(bm::State& state) {
+  auto v = make_sparse<dense>();
+
+  for (auto _ : state) {
+    std::size_t n = 0;
+    for (auto e : v) {
+      n += e.type_index == 2;
+    }
+    bm::DoNotOptimize(n);
+  }
+}
+
+void bench_count_indexed(bm::State& state) {
+  auto v = make_sparse<indexed>();
+
+  for (auto _ : state) {
+    bm::DoNotOptimize(v.count<std::string>());
+  }
+}
+
+void bench_visit_strings_scan_vv3(bm::State& state) {
+  auto v = make_sparse<dense>();
+
+  for (auto _ : state) {
+    std::size_t len = 0;
+    for (auto e : v) {
+      if (e.type_index == 2) {
+        len += reinterpret_cast<std::string*>(e.data)->size();
+      }
+    }
+    bm::DoNotOptimize(len);
+  }
+}
+
+void bench_for_each_of_indexed(bm::State& state) {
+  auto v = make_sparse<indexed>();
+
+  for (auto _ : state) {
+    std::size_t len = 0;
+    v.for_each_of<std::string>([&](std::string& s) { len += s.size(); });
+    bm::DoNotOptimize(len);
+  }
+}
+
+BENCHMARK(bench_push_back_vv3)->Unit(bm::kMicrosecond);
+BENCHMARK(bench_push_back_indexed)->Unit(bm::kMicrosecond);
+BENCHMARK(bench_count_scan_vv3)->Unit(bm::kMicrosecond);
+BENCHMARK(bench_count_indexed)->Unit(bm::kMicrosecond);
+BENCHMARK(bench_visit_strings_scan_vv3)->Unit(bm::kMicrosecond);
+BENCHMARK(bench_for_each_of_indexed)->Unit(bm::kMicrosecond);
+BENCHMARK_MAIN();
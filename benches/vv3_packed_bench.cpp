@@ -0,0 +1,61 @@
+#include "../include/vv3.hpp"
+#include "../include/vv3_packed.hpp"
+#include <benchmark/benchmark.h>
+
+namespace bm = benchmark;
+
+constexpr std::size_t num_iter = 20000;
+
+using padded = vv3::vector<char, double>;
+using packed = vv3::packed_vector<char, double>;
+
+// char, double alternating: the worst case for padding
+template <class Vector> Vector make_mix() {
+  Vector v;
+  for (std::size_t i = 0; i < num_iter; i++) {
+    if (i % 2 == 0) {
+      v.push_back(static_cast<char>(i));
+    } else {
+      v.push_back(static_cast<double>(i));
+    }
+  }
+  return v;
+}
+
+void bench_sum_padded(bm::State& state) {
+  auto v = make_mix<padded>();
+  for (auto _ : state) {
+    double sum = 0;
+    for (std::size_t i = 1; i < num_iter; i += 2) {
+      sum += v.get<double>(i);
+    }
+    bm::DoNotOptimize(sum);
+  }
+  state.counters["payload_bytes"] = static_cast<double>(v.payload_bytes() +
+                                                        v.padding_bytes());
+}
+
+void bench_sum_packed(bm::State& state) {
+  auto v = make_mix<packed>();
+  for (auto _ : state) {
+    double sum = 0;
+    for (std::size_t i = 1; i < num_iter; i += 2) {
+      sum += v.load<double>(i);
+    }
+    bm::DoNotOptimize(sum);
+  }
+  state.counters["payload_bytes"] = static_cast<double>(v.payload_bytes());
+}
+
+template <class Vector> void bench_ingest(bm::State& state) {
+  for (auto _ : state) {
+    auto v = make_mix<Vector>();
+    bm::DoNotOptimize(v);
+  }
+}
+
+BENCHMARK(bench_sum_padded)->Unit(bm::kMicrosecond);
+BENCHMARK(bench_sum_packed)->Unit(bm::kMicrosecond);
+BENCHMARK(bench_ingest<padded>)->Unit(bm::kMicrosecond);
+BENCHMARK(bench_ingest<packed>)->Unit(bm::kMicrosecond);
+BENCHMARK_MAIN();
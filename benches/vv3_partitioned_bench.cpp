@@ -0,0 +1,82 @@
+#include "../include/vv3.hpp"
+#include "../include/vv3_partitioned.hpp"
+#include <benchmark/benchmark.h>
+
+namespace bm = benchmark;
+
+constexpr std::size_t num_iter = 20000;
+
+using dense = vv3::vector<char, int, long long, double>;
+using partitioned = vv3::partitioned_vector<char, int, long long, double>;
+
+template <class Vector> Vector make_numeric() {
+  Vector v;
+  for (std::size_t i = 0; i < num_iter; i++) {
+    switch (i % 4) {
+    case 0:
+      v.push_back(static_cast<char>(i));
+      break;
+    case 1:
+      v.push_back(static_cast<int>(i));
+      break;
+    case 2:
+      v.push_back(static_cast<long long>(i));
+      break;
+    default:
+      v.push_back(static_cast<double>(i));
+      break;
+    }
+  }
+  return v;
+}
+
+template <class Vector> void bench_ingest(bm::State& state) {
+  for (auto _ : state) {
+    auto v = make_numeric<Vector>();
+    bm::DoNotOptimize(v);
+  }
+}
+
+// sum of every double: a tag test per element for vv3::vector, a loop over
+// double[] for the partitioned one
+void bench_sum_doubles_dense(bm::State& state) {
+  auto v = make_numeric<dense>();
+  for (auto _ : state) {
+    double sum = 0;
+    for (auto e : v) {
+      if (e.type_index == 3) {
+        sum += *reinterpret_cast<double*>(e.data);
+      }
+    }
+    bm::DoNotOptimize(sum);
+  }
+}
+
+void bench_sum_doubles_partitioned(bm::State& state) {
+  auto v = make_numeric<partitioned>();
+  for (auto _ : state) {
+    double sum = 0;
+    v.for_each_of<double>([&](double x) { sum += x; });
+    bm::DoNotOptimize(sum);
+  }
+}
+
+// positional access, where the partitioned layout pays its extra indirection
+template <class Vector> void bench_index(bm::State& state) {
+  auto v = make_numeric<Vector>();
+  for (auto _ : state) {
+    std::size_t sum = 0;
+    for (std::size_t i = 0; i < v.size(); i++) {
+      sum += *reinterpret_cast<unsigned char*>(v[i].data);
+    }
+    bm::DoNotOptimize(sum);
+  }
+}
+
+BENCHMARK(bench_ingest<dense>)->Unit(bm::kMicrosecond);
+BENCHMARK(bench_ingest<partitioned>)->Unit(bm::kMicrosecond);
+BENCHMARK(bench_sum_doubles_dense)->Unit(bm::kMicrosecond);
+BENCHMARK(bench_sum_doubles_partitioned)->Unit(bm::kMicrosecond);
+BENCHMARK(bench_index<dense>)->Unit(bm::kMicrosecond);
+BENCHMARK(bench_index<partitioned>)->Unit(bm::kMicrosecond);
+BENCHMARK_MAIN();
@@ -0,0 +1,74 @@
+#include "../include/vv3.hpp"
+#include "../include/vv3_rle.hpp"
+#include <benchmark/benchmark.h>
+
+namespace bm = benchmark;
+
+constexpr std::size_t num_iter = 20000;
+
+using dense = vv3::vector<int, long long, double>;
+using rle = vv3::rle_vector<int, long long, double>;
+
+// runs of state.range(0) elements, cycling through the alternatives
+template <class Vector> Vector make_runs(std::size_t run) {
+  Vector v;
+  for (std::size_t i = 0; i < num_iter; i++) {
+    switch (i / run % 3) {
+    case 0:
+      v.push_back(static_cast<int>(i));
+      break;
+    case 1:
+      v.push_back(static_cast<long long>(i));
+      break;
+    default:
+      v.push_back(static_cast<double>(i));
+      break;
+    }
+  }
+  return v;
+}
+
+struct summer {
+  double sum = 0;
+
+  template <class T> void operator()(T& x) { sum += static_cast<double>(x); }
+};
+
+template <class Vector> void bench_for_each(bm::State& state) {
+  auto v = make_runs<Vector>(static_cast<std::size_t>(state.range(0)));
+  for (auto _ : state) {
+    summer s;
+    v.for_each(s);
+    bm::DoNotOptimize(s.sum);
+  }
+}
+
+template <class Vector> void bench_index(bm::State& state) {
+  auto v = make_runs<Vector>(static_cast<std::size_t>(state.range(0)));
+  for (auto _ : state) {
+    std::size_t sum = 0;
+    for (std::size_t i = 0; i < v.size(); i++) {
+      sum += *reinterpret_cast<unsigned char*>(v[i].data);
+    }
+    bm::DoNotOptimize(sum);
+  }
+}
+
+template <class Vector> void bench_iterate(bm::State& state) {
+  auto v = make_runs<Vector>(static_cast<std::size_t>(state.range(0)));
+  for (auto _ : state) {
+    std::size_t sum = 0;
+    for (auto e : v) {
+      sum += e.type_index + *reinterpret_cast<unsigned char*>(e.data);
+    }
+    bm::DoNotOptimize(sum);
+  }
+}
+
+BENCHMARK(bench_for_each<dense>)->Arg(1)->Arg(1000)->Unit(bm::kMicrosecond);
+BENCHMARK(bench_for_each<rle>)->Arg(1)->Arg(1000)->Unit(bm::kMicrosecond);
+BENCHMARK(bench_index<dense>)->Arg(1)->Arg(1000)->Unit(bm::kMicrosecond);
+BENCHMARK(bench_index<rle>)->Arg(1)->Arg(1000)->Unit(bm::kMicrosecond);
+BENCHMARK(bench_iterate<dense>)->Arg(1)->Arg(1000)->Unit(bm::kMicrosecond);
+BENCHMARK(bench_iterate<rle>)->Arg(1)->Arg(1000)->Unit(bm::kMicrosecond);
+BENCHMARK_MAIN();
@@ -0,0 +1,157 @@
+#include "../include/vv3.hpp"
+#include "../include/vv4.hpp"
+#include <benchmark/benchmark.h>
+#include <cstdlib>
+
+namespace bm = benchmark;
+
+constexpr std::size_t num_iter = 1 << 16;
+
+// random alternatives; int is the one being searched for
+template <class Vector> Vector make_mixed() {
+  Vector v;
+  std::srand(42);
+  for (std::size_t i = 0; i < num_iter; i++) {
+    switch (std::rand() % 4) {
+    case 0:
+      v.push_back(static_cast<int>(i));
+      break;
+    case 1:
+      v.push_back(static_cast<char>(i));
+      break;
+    case 2:
+      v.push_back(static_cast<float>(i));
+      break;
+    default:
+      v.push_back(static_cast<double>(i));
+      break;
+    }
+  }
+  return v;
+}
+
+using vv3_vec = vv3::vector<int, char, float, double>;
+using vv5_vec = vv5::vector<int, char, float, double>;
+
+// the loop consumers write without the scan kernels
+void bench_count_scalar_vv3(bm::State& state) {
+  auto v = make_mixed<vv3_vec>();
+
+  for (auto _ : state) {
+    std::size_t n = 0;
+    for (std::size_t i = 0; i < v.size(); i++) {
+      n += v[i].type_index == 0;
+    }
+    bm::DoNotOptimize(n);
+  }
+}
+
+void bench_count_type_vv3(bm::State& state) {
+  auto v = make_mixed<vv3_vec>();
+
+  for (auto _ : state) {
+    bm::DoNotOptimize(v.count_type<int>());
+  }
+}
+
+void bench_mask_scalar_vv3(bm::State& state) {
+  auto v = make_mixed<vv3_vec>();
+
+  for (auto _ : state) {
+    std::vector<std::uint64_t> mask((v.size() + 63) / 64);
+    for (std::size_t i = 0; i < v.size(); i++) {
+      mask[i / 64] |= std::uint64_t{v[i].type_index == 0} << (i % 64);
+    }
+    bm::DoNotOptimize(mask.data());
+  }
+}
+
+void bench_type_mask_vv3(bm::State& state) {
+  auto v = make_mixed<vv3_vec>();
+
+  for (auto _ : state) {
+    auto mask = v.type_mask<int>();
+    bm::DoNotOptimize(mask.data());
+  }
+}
+
+// walks every int with find_type vs checking each tag
+void bench_find_scalar_vv3(bm::State& state) {
+  auto v = make_mixed<vv3_vec>();
+
+  for (auto _ : state) {
+    std::size_t n = 0;
+    for (std::size_t i = 0; i < v.size(); i++) {
+      if (v[i].type_index == 0) {
+        n += i;
+      }
+    }
+    bm::DoNotOptimize(n);
+  }
+}
+
+void bench_find_type_vv3(bm::State& state) {
+  auto v = make_mixed<vv3_vec>();
+
+  for (auto _ : state) {
+    std::size_t n = 0;
+    for (std::size_t i = v.find_type<int>(); i < v.size();
+         i = v.find_type<int>(i + 1)) {
+      n += i;
+    }
+    bm::DoNotOptimize(n);
+  }
+}
+
+void bench_count_scalar_vv5(bm::State& state) {
+  auto v = make_mixed<vv5_vec>();
+
+  for (auto _ : state) {
+    std::size_t n = 0;
+    for (std::size_t i = 0; i < v.size(); i++) {
+      n += v.type_index(i) == 0;
+    }
+    bm::DoNotOptimize(n);
+  }
+}
+
+void bench_count_type_vv5(bm::State& state) {
+  auto v = make_mixed<vv5_vec>();
+
+  for (auto _ : state) {
+    bm::DoNotOptimize(v.count_type<int>());
+  }
+}
+
+void bench_mask_scalar_vv5(bm::State& state) {
+  auto v = make_mixed<vv5_vec>();
+
+  for (auto _ : state) {
+    std::vector<std::uint64_t> mask((v.size() + 63) / 64);
+    for (std::size_t i = 0; i < v.size(); i++) {
+      mask[i / 64] |= std::uint64_t{v.type_index(i) == 0} << (i % 64);
+    }
+    bm::DoNotOptimize(mask.data());
+  }
+}
+
+void bench_type_mask_vv5(bm::State& state) {
+  auto v = make_mixed<vv5_vec>();
+
+  for (auto _ : state) {
+    auto mask = v.type_mask<int>();
+    bm::DoNotOptimize(mask.data());
+  }
+}
+
+BENCHMARK(bench_count_scalar_vv3)->Unit(bm::kMicrosecond);
+BENCHMARK(bench_count_type_vv3)->Unit(bm::kMicrosecond);
+BENCHMARK(bench_mask_scalar_vv3)->Unit(bm::kMicrosecond);
+BENCHMARK(bench_type_mask_vv3)->Unit(bm::kMicrosecond);
+BENCHMARK(bench_find_scalar_vv3)->Unit(bm::kMicrosecond);
+BENCHMARK(bench_find_type_vv3)->Unit(bm::kMicrosecond);
+BENCHMARK(bench_count_scalar_vv5)->Unit(bm::kMicrosecond);
+BENCHMARK(bench_count_type_vv5)->Unit(bm::kMicrosecond);
+BENCHMARK(bench_mask_scalar_vv5)->Unit(bm::kMicrosecond);
+BENCHMARK(bench_type_mask_vv5)->Unit(bm::kMicrosecond);
+BENCHMARK_MAIN();
@@ -0,0 +1,55 @@
+#include "../include/vv3.hpp"
+#include "../include/vv3_segmented.hpp"
+#include <benchmark/benchmark.h>
+#include <chrono>
+#include <string>
+
+namespace bm = benchmark;
+
+constexpr std::size_t num_iter = 20000;
+
+using dense = vv3::vector<int, double, std::string>;
+using segmented = vv3::segmented_vector<4096, int, double, std::string>;
+
+// total ingest time plus the slowest single append, which for vv3::vector is
+// the growth that relocates everything
+template <class Vector> void bench_ingest(bm::State& state) {
+  double worst_ns = 0;
+  for (auto _ : state) {
+    Vector v;
+    for (std::size_t i = 0; i < num_iter; i++) {
+      auto start = std::chrono::steady_clock::now();
+      if (i % 8 == 0) {
+        v.push_back(std::string("payload"));
+      } else {
+        v.push_back(static_cast<double>(i));
+      }
+      std::chrono::duration<double, std::nano> took =
+          std::chrono::steady_clock::now() - start;
+      worst_ns = std::max(worst_ns, took.count());
+    }
+    bm::DoNotOptimize(v);
+  }
+  state.counters["worst_append_ns"] = worst_ns;
+}
+
+template <class Vector> void bench_index(bm::State& state) {
+  Vector v;
+  for (std::size_t i = 0; i < num_iter; i++) {
+    v.push_back(static_cast<double>(i));
+  }
+
+  for (auto _ : state) {
+    double sum = 0;
+    for (std::size_t i = 0; i < v.size(); i++) {
+      sum += *reinterpret_cast<double*>(v[i].data);
+    }
+    bm::DoNotOptimize(sum);
+  }
+}
+
+BENCHMARK(bench_ingest<dense>)->Unit(bm::kMicrosecond);
+BENCHMARK(bench_ingest<segmented>)->Unit(bm::kMicrosecond);
+BENCHMARK(bench_index<dense>)->Unit(bm::kMicrosecond);
+BENCHMARK(bench_index<segmented>)->Unit(bm::kMicrosecond);
+BENCHMARK_MAIN();
@@ -0,0 +1,70 @@
+#include "../include/vv0.hpp"
+#include "../include/vv3.hpp"
+#include <benchmark/benchmark.h>
+#include <string>
+
+namespace bm = benchmark;
+
+constexpr std::size_t num_vectors = 1000;
+constexpr int num_elements = 6;
+
+// short-lived vectors holding fewer than eight elements, the case the inline
+// buffer is meant for
+template <class Vector> void push_short(Vector& v) {
+  for (int i = 0; i < num_elements; i++) {
+    if (i % 3 == 0) {
+      v.push_back(i);
+    } else if (i % 3 == 1) {
+      v.push_back(i * 0.5);
+    } else {
+      v.push_back(std::string("short"));
+    }
+  }
+}
+
+void bench_build_vv0(bm::State& state) {
+  for (auto _ : state) {
+    for (std::size_t i = 0; i < num_vectors; i++) {
+      vv0::vector<int, double, std::string> v;
+      push_short(v);
+      bm::DoNotOptimize(v);
+    }
+  }
+}
+
+void bench_build_vv3(bm::State& state) {
+  for (auto _ : state) {
+    for (std::size_t i = 0; i < num_vectors; i++) {
+      vv3::vector<int, double, std::string> v;
+      push_short(v);
+      bm::DoNotOptimize(v);
+    }
+  }
+}
+
+void bench_build_small(bm::State& state) {
+  for (auto _ : state) {
+    for (std::size_t i = 0; i < num_vectors; i++) {
+      vv3::small_vector<256, int, double, std::string> v;
+      push_short(v);
+      bm::DoNotOptimize(v);
+    }
+  }
+}
+
+void bench_index_small(bm::State& state) {
+  vv3::small_vector<256, int, double, std::string> v;
+  push_short(v);
+
+  for (auto _ : state) {
+    for (int i = 0; i < num_elements; i += 3) {
+      bm::DoNotOptimize(v.get<int>(i));
+    }
+  }
+}
+
+BENCHMARK(bench_build_vv0)->Unit(bm::kMicrosecond);
+BENCHMARK(bench_build_vv3)->Unit(bm::kMicrosecond);
+BENCHMARK(bench_build_small)->Unit(bm::kMicrosecond);
+BENCHMARK(bench_index_small);
+BENCHMARK_MAIN();
@@ -0,0 +1,70 @@
+#include "../include/vv3.hpp"
+#include "../include/vv3_stream.hpp"
+#include <benchmark/benchmark.h>
+#include <cstdlib>
+
+namespace bm = benchmark;
+
+constexpr std::size_t num_iter = 5000;
+
+template <class Vector> Vector make_mixed() {
+  Vector v;
+  std::srand(42);
+  for (std::size_t i = 0; i < num_iter; i++) {
+    switch (std::rand() % 3) {
+    case 0:
+      v.push_back(static_cast<char>(i));
+      break;
+    case 1:
+      v.push_back(static_cast<int>(i));
+      break;
+    default:
+      v.push_back(static_cast<double>(i));
+      break;
+    }
+  }
+  return v;
+}
+
+template <class Vector> void bench_push_back(bm::State& state) {
+  for (auto _ : state) {
+    auto v = make_mixed<Vector>();
+    bm::DoNotOptimize(v);
+  }
+}
+
+// the common path: one front to back pass
+template <class Vector> void bench_scan(bm::State& state) {
+  auto v = make_mixed<Vector>();
+
+  for (auto _ : state) {
+    double sum = 0;
+    v.for_each([&](auto& x) { sum += static_cast<double>(x); });
+    bm::DoNotOptimize(sum);
+  }
+}
+
+// the cost of dropping offsets: every lookup walks from a checkpoint
+template <class Vector> void bench_random_access(bm::State& state) {
+  auto v = make_mixed<Vector>();
+
+  for (auto _ : state) {
+    std::size_t sum = 0;
+    for (std::size_t i = 0; i < v.size(); i++) {
+      auto e = v[(i * 7919) % v.size()];
+      sum += e.type_index + std::to_integer<std::size_t>(*e.data);
+    }
+    bm::DoNotOptimize(sum);
+  }
+}
+
+using dense = vv3::vector<char, int, double>;
+using stream = vv3::stream_vector<char, int, double>;
+
+BENCHMARK(bench_push_back<dense>)->Unit(bm::kMicrosecond);
+BENCHMARK(bench_push_back<stream>)->Unit(bm::kMicrosecond);
+BENCHMARK(bench_scan<dense>)->Unit(bm::kMicrosecond);
+BENCHMARK(bench_scan<stream>)->Unit(bm::kMicrosecond);
+BENCHMARK(bench_random_access<dense>)->Unit(bm::kMicrosecond);
+BENCHMARK(bench_random_access<stream>)->Unit(bm::kMicrosecond);
+BENCHMARK_MAIN();
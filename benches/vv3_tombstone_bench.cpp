@@ -0,0 +1,91 @@
+#include "../include/vv3.hpp"
+#include "../include/vv3_tombstone.hpp"
+#include <benchmark/benchmark.h>
+#include <string>
+
+namespace bm = benchmark;
+
+constexpr std::size_t window = 4096;
+constexpr std::size_t step = 16;
+
+using shifting = vv3::vector<int, double, std::string>;
+using tombstoned = vv3::tombstone_vector<int, double, std::string>;
+
+template <class Vector> void append(Vector& v, std::size_t k) {
+  switch (k % 3) {
+  case 0:
+    v.push_back(static_cast<int>(k));
+    break;
+  case 1:
+    v.push_back(static_cast<double>(k));
+    break;
+  default:
+    v.push_back(std::string("k"));
+  }
+}
+
+// slide a window of `window` elements forward by `step` per iteration: erase
+// the oldest, append the newest, read the front
+template <class Vector> void bench_sliding_window(bm::State& state) {
+  Vector v;
+  std::size_t k = 0;
+  for (; k < window; k++) {
+    append(v, k);
+  }
+  for (auto _ : state) {
+    v.erase(0, step);
+    for (std::size_t i = 0; i < step; i++, k++) {
+      append(v, k);
+    }
+    bm::DoNotOptimize(v[0].data);
+  }
+}
+
+// a full pass by index over the window after each slide. tombstones are
+// pending for most of these, so every lookup has to skip them
+template <class Vector> void bench_index_after_erase(bm::State& state) {
+  Vector v;
+  std::size_t k = 0;
+  for (; k < window; k++) {
+    append(v, k);
+  }
+  for (auto _ : state) {
+    v.erase(0, step);
+    for (std::size_t i = 0; i < step; i++, k++) {
+      append(v, k);
+    }
+    std::size_t sum = 0;
+    for (std::size_t i = 0; i < v.size(); i++) {
+      sum += v[i].type_index;
+    }
+    bm::DoNotOptimize(sum);
+  }
+}
+
+// what you'd do without erase: copy the survivors into a new vector
+void bench_sliding_window_rebuild(bm::State& state) {
+  shifting v;
+  std::size_t k = 0;
+  for (; k < window; k++) {
+    append(v, k);
+  }
+  for (auto _ : state) {
+    shifting next;
+    next.reserve_entries(window);
+    for (std::size_t i = step; i < v.size(); i++) {
+      v.visit(i, [&](auto& x) { next.push_back(x); });
+    }
+    for (std::size_t i = 0; i < step; i++, k++) {
+      append(next, k);
+    }
+    v = std::move(next);
+    bm::DoNotOptimize(v[0].data);
+  }
+}
+
+BENCHMARK(bench_sliding_window<shifting>)->Unit(bm::kMicrosecond);
+BENCHMARK(bench_sliding_window<tombstoned>)->Unit(bm::kMicrosecond);
+BENCHMARK(bench_index_after_erase<shifting>)->Unit(bm::kMicrosecond);
+BENCHMARK(bench_index_after_erase<tombstoned>)->Unit(bm::kMicrosecond);
+BENCHMARK(bench_sliding_window_rebuild)->Unit(bm::kMicrosecond);
+BENCHMARK_MAIN();
@@ -0,0 +1,93 @@
+#include "../include/vv0.hpp"
+#include "../include/vv3.hpp"
+#include <benchmark/benchmark.h>
+#include <cstdlib>
+#include <variant>
+
+namespace bm = benchmark;
+
+constexpr std::size_t num_iter = 5000;
+
+// random alternatives so the dispatch branch can't be predicted
+template <class Vector> Vector make_mixed() {
+  Vector v;
+  std::srand(42);
+  for (std::size_t i = 0; i < num_iter; i++) {
+    switch (std::rand() % 3) {
+    case 0:
+      v.push_back(static_cast<int>(i));
+      break;
+    case 1:
+      v.push_back(static_cast<double>(i));
+      break;
+    default:
+      v.push_back(static_cast<long long>(i));
+      break;
+    }
+  }
+  return v;
+}
+
+void bench_std_visit_vv0(bm::State& state) {
+  auto v = make_mixed<vv0::vector<int, double, long long>>();
+
+  for (auto _ : state) {
+    double sum = 0;
+    for (auto& e : v) {
+      std::visit([&](auto& x) { sum += static_cast<double>(x); }, e);
+    }
+    bm::DoNotOptimize(sum);
+  }
+}
+
+void bench_visit_vv3(bm::State& state) {
+  auto v = make_mixed<vv3::vector<int, double, long long>>();
+
+  for (auto _ : state) {
+    double sum = 0;
+    for (std::size_t i = 0; i < v.size(); i++) {
+      v.visit(i, [&](auto& x) { sum += static_cast<double>(x); });
+    }
+    bm::DoNotOptimize(sum);
+  }
+}
+
+void bench_for_each_vv3(bm::State& state) {
+  auto v = make_mixed<vv3::vector<int, double, long long>>();
+
+  for (auto _ : state) {
+    double sum = 0;
+    v.for_each([&](auto& x) { sum += static_cast<double>(x); });
+    bm::DoNotOptimize(sum);
+  }
+}
+
+// what consumers write by hand today
+void bench_switch_vv3(bm::State& state) {
+  auto v = make_mixed<vv3::vector<int, double, long long>>();
+
+  for (auto _ : state) {
+    double sum = 0;
+    for (std::size_t i = 0; i < v.size(); i++) {
+      auto e = v[i];
+      switch (e.type_index) {
+      case 0:
+        sum += *reinterpret_cast<int*>(e.data);
+        break;
+      case 1:
+        sum += *reinterpret_cast<double*>(e.data);
+        break;
+      default:
+        sum += static_cast<double>(*reinterpret_cast<long long*>(e.data));
+        break;
+      }
+    }
+    bm::DoNotOptimize(sum);
+  }
+}
+
+BENCHMARK(bench_std_visit_vv0)->Unit(bm::kMicrosecond);
+BENCHMARK(bench_visit_vv3)->Unit(bm::kMicrosecond);
+BENCHMARK(bench_for_each_vv3)->Unit(bm::kMicrosecond);
+BENCHMARK(bench_switch_vv3)->Unit(bm::kMicrosecond);
+BENCHMARK_MAIN();
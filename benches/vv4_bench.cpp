@@ -1,9 +1,9 @@
-#include "../include/vv3.hpp"
+#include "../include/vv4.hpp"
 #include <benchmark/benchmark.h>
 #include <cstdlib>
 
 namespace bm = benchmark;
-using vv3::vector;
+using vv5::vector;
 
 constexpr std::size_t num_iter = 5000;
 
@@ -38,8 +38,45 @@ void bench_index(bm::State& state) {
   }
 }
 
+// mixed small alternatives, where the tag array is a large share of the
+// per-element footprint
+void bench_pushback_small(bm::State& state) {
+  for (auto _ : state) {
+    vector<int, double, long long> v;
+    for (std::size_t i = 0; i < num_iter; i++) {
+      if (i % 3 == 0) {
+        v.push_back(static_cast<int>(i));
+      } else if (i % 3 == 1) {
+        v.push_back(static_cast<double>(i));
+      } else {
+        v.push_back(static_cast<long long>(i));
+      }
+    }
+    bm::DoNotOptimize(v);
+  }
+}
+
+void bench_type_scan(bm::State& state) {
+  vector<int, double, long long> v;
+  for (std::size_t i = 0; i < num_iter; i++) {
+    if (i % 3 == 0) {
+      v.push_back(static_cast<int>(i));
+    } else {
+      v.push_back(static_cast<double>(i));
+    }
+  }
+
+  for (auto _ : state) {
+    std::size_t ints = 0;
+    for (std::size_t i = 0; i < v.size(); i++) {
+      ints += v.type_index(i) == 0;
+    }
+    bm::DoNotOptimize(ints);
+  }
+}
+
 BENCHMARK(bench_pushback)->Unit(bm::kMillisecond);
 BENCHMARK(bench_index)->Unit(bm::kMillisecond);
+BENCHMARK(bench_pushback_small)->Unit(bm::kMicrosecond);
+BENCHMARK(bench_type_scan)->Unit(bm::kMicrosecond);
 BENCHMARK_MAIN();
-
-
@@ -0,0 +1,171 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdlib>
+#include <memory>
+#include <new>
+
+// instrumentation for benchmarks and tests: counts allocations, frees, live
+// bytes and the high-water mark, either for everything that goes through the
+// global operator new (any vv container) or per allocator (the allocator-aware
+// vv3 containers). counters are plain integers, so keep tracked code on one
+// thread.
+//
+// the global hook replaces operator new/delete, so it has to be defined in
+// exactly one translation unit of the program:
+//
+//   #define VV_TRACK_GLOBAL_ALLOCATIONS
+//   #include "alloc_tracking.hpp"
+//
+//   alloc_tracking::scope s;
+//   ... build a container ...
+//   s.allocations(); s.held(); s.peak_above();
+namespace alloc_tracking {
+
+struct stats {
+  std::size_t allocations = 0;
+  std::size_t deallocations = 0;
+  std::size_t live = 0; // bytes currently allocated
+  std::size_t peak = 0; // highest `live` since the last scope started
+
+  void on_allocate(std::size_t n) {
+    allocations++;
+    live += n;
+    peak = std::max(peak, live);
+  }
+
+  void on_deallocate(std::size_t n) {
+    deallocations++;
+    live -= n;
+  }
+};
+
+// what the global hook counts into, when it is compiled in
+inline stats global;
+
+// counters relative to when the scope started. starting a scope resets the
+// peak to the current live bytes, so peak_above() is this scope's own high
+// water mark
+class scope {
+public:
+  explicit scope(stats& s = global)
+      : s(s), allocations0(s.allocations), deallocations0(s.deallocations),
+        live0(s.live) {
+    s.peak = s.live;
+  }
+
+  [[nodiscard]] std::size_t allocations() const {
+    return s.allocations - allocations0;
+  }
+
+  [[nodiscard]] std::size_t deallocations() const {
+    return s.deallocations - deallocations0;
+  }
+
+  // bytes allocated in this scope and not freed yet
+  [[nodiscard]] std::size_t held() const { return s.live - live0; }
+
+  [[nodiscard]] std::size_t peak_above() const { return s.peak - live0; }
+
+private:
+  stats& s;
+  std::size_t allocations0;
+  std::size_t deallocations0;
+  std::size_t live0;
+};
+
+// std::allocator that reports to a stats object, for counting one container
+// without replacing the global operator new
+template <class T> class tracking_allocator {
+public:
+  using value_type = T;
+
+  explicit tracking_allocator(stats& s) noexcept : s(&s) {}
+
+  template <class U>
+  tracking_allocator(const tracking_allocator<U>& rhs) noexcept
+      : s(rhs.get_stats()) {}
+
+  [[nodiscard]] T* allocate(std::size_t n) {
+    T* p = std::allocator<T>().allocate(n);
+    s->on_allocate(n * sizeof(T));
+    return p;
+  }
+
+  void deallocate(T* p, std::size_t n) noexcept {
+    s->on_deallocate(n * sizeof(T));
+    std::allocator<T>().deallocate(p, n);
+  }
+
+  [[nodiscard]] stats* get_stats() const noexcept { return s; }
+
+  template <class U>
+  [[nodiscard]] bool operator==(const tracking_allocator<U>& rhs) const {
+    return s == rhs.get_stats();
+  }
+
+private:
+  stats* s;
+};
+
+namespace detail {
+
+// every block is preceded by its size, in a prefix as large as its alignment,
+// so the unsized operator delete can still count bytes
+inline void* allocate(std::size_t n, std::size_t align) {
+  std::size_t total = (n + 2 * align - 1) / align * align;
+  auto* base = static_cast<std::byte*>(std::aligned_alloc(align, total));
+  if (!base) {
+    throw std::bad_alloc();
+  }
+  std::byte* p = base + align;
+  reinterpret_cast<std::size_t*>(p)[-1] = n;
+  global.on_allocate(n);
+  return p;
+}
+
+inline void deallocate(void* ptr, std::size_t align) noexcept {
+  if (ptr) {
+    auto* p = static_cast<std::byte*>(ptr);
+    global.on_deallocate(reinterpret_cast<std::size_t*>(p)[-1]);
+    std::free(p - align);
+  }
+}
+
+inline std::size_t align_of(std::align_val_t align) {
+  return std::max<std::size_t>(static_cast<std::size_t>(align),
+                               __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+}
+
+} // namespace detail
+
+} // namespace alloc_tracking
+
+#ifdef VV_TRACK_GLOBAL_ALLOCATIONS
+
+// the array, sized and nothrow forms all forward to these by default
+void* operator new(std::size_t n) {
+  return alloc_tracking::detail::allocate(n, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+}
+
+void* operator new(std::size_t n, std::align_val_t align) {
+  return alloc_tracking::detail::allocate(
+      n, alloc_tracking::detail::align_of(align));
+}
+
+void operator delete(void* p) noexcept {
+  alloc_tracking::detail::deallocate(p, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+}
+
+void operator delete(void* p, std::align_val_t align) noexcept {
+  alloc_tracking::detail::deallocate(p, alloc_tracking::detail::align_of(align));
+}
+
+void operator delete(void* p, std::size_t) noexcept { operator delete(p); }
+
+void operator delete(void* p, std::size_t, std::align_val_t align) noexcept {
+  operator delete(p, align);
+}
+
+#endif
@@ -1,18 +1,41 @@
 #pragma once
 
+#include <algorithm>
+#include <bit>
 #include <cassert>
 #include <cstddef>
 #include <cstdint>
 #include <cstring>
+#include <functional>
 #include <iostream>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <memory_resource>
+#include <new>
+#include <numeric>
 #include <type_traits>
 #include <typeinfo>
 #include <utility>
+#include <vector>
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
 
 namespace vv3 {
 
-struct Element {
-  std::size_t type_index;
+// smallest unsigned type able to hold the value `N`
+template <std::size_t N>
+using tag_for_t = std::conditional_t<
+    N <= std::numeric_limits<std::uint8_t>::max(), std::uint8_t,
+    std::conditional_t<
+        N <= std::numeric_limits<std::uint16_t>::max(), std::uint16_t,
+        std::conditional_t<N <= std::numeric_limits<std::uint32_t>::max(),
+                           std::uint32_t, std::uint64_t>>>;
+
+template <class Tag = std::size_t> struct Element {
+  Tag type_index;
   std::byte* data;
 };
 
@@ -21,6 +44,182 @@ constexpr std::size_t get_padding(std::uintptr_t addr, std::size_t align) {
   return aligned_addr - addr;
 }
 
+// smallest offset width, in bytes, able to address every byte of a buffer of
+// `capacity` bytes
+constexpr std::uint8_t offset_width_for(std::size_t capacity) {
+  if (capacity <= (std::size_t{1} << 8)) {
+    return 1;
+  } else if (capacity <= (std::size_t{1} << 16)) {
+    return 2;
+  } else if (capacity <= (std::size_t{1} << 32)) {
+    return 4;
+  }
+  return 8;
+}
+
+constexpr std::size_t align_up(std::size_t n, std::size_t align) {
+  return n + get_padding(n, align);
+}
+
+// offsets are stored as `width`-byte unsigned integers
+inline std::size_t load_offset(const std::byte* const offsets,
+                               std::uint8_t width, std::size_t index) {
+  switch (width) {
+  case 1:
+    return reinterpret_cast<const std::uint8_t*>(offsets)[index];
+  case 2:
+    return reinterpret_cast<const std::uint16_t*>(offsets)[index];
+  case 4:
+    return reinterpret_cast<const std::uint32_t*>(offsets)[index];
+  default:
+    return reinterpret_cast<const std::uint64_t*>(offsets)[index];
+  }
+}
+
+inline void store_offset(std::byte* const offsets, std::uint8_t width,
+                         std::size_t index, std::size_t offset) {
+  switch (width) {
+  case 1:
+    reinterpret_cast<std::uint8_t*>(offsets)[index] =
+        static_cast<std::uint8_t>(offset);
+    break;
+  case 2:
+    reinterpret_cast<std::uint16_t*>(offsets)[index] =
+        static_cast<std::uint16_t>(offset);
+    break;
+  case 4:
+    reinterpret_cast<std::uint32_t*>(offsets)[index] =
+        static_cast<std::uint32_t>(offset);
+    break;
+  default:
+    reinterpret_cast<std::uint64_t*>(offsets)[index] = offset;
+    break;
+  }
+}
+
+// tag scans used by count_type/find_type/type_mask. the scalar versions are
+// the fallback, and the only path for tags wider than a byte (compilers
+// vectorize those loops well enough on their own). all of them look at
+// [first, n)
+namespace detail {
+
+template <class Tag>
+std::size_t count_tags_scalar(const Tag* tags, std::size_t first,
+                              std::size_t n, Tag k) {
+  std::size_t count = 0;
+  for (std::size_t i = first; i < n; i++) {
+    count += tags[i] == k;
+  }
+  return count;
+}
+
+template <class Tag>
+std::size_t find_tag_scalar(const Tag* tags, std::size_t first, std::size_t n,
+                            Tag k) {
+  for (std::size_t i = first; i < n; i++) {
+    if (tags[i] == k) {
+      return i;
+    }
+  }
+  return n;
+}
+
+// sets bit i % 64 of out[i / 64] for every match; `out` starts zeroed
+template <class Tag>
+void mask_tags_scalar(const Tag* tags, std::size_t first, std::size_t n, Tag k,
+                      std::uint64_t* out) {
+  for (std::size_t i = first; i < n; i++) {
+    out[i / 64] |= std::uint64_t{tags[i] == k} << (i % 64);
+  }
+}
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#define VV3_SIMD_TAG_SCAN 1
+
+// bit j set iff p[j] == k, for one register's worth of byte tags
+#if defined(__AVX2__)
+inline constexpr std::size_t tag_lanes = 32;
+
+inline std::uint32_t match_lanes(const std::uint8_t* p, std::uint8_t k) {
+  __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+  __m256i eq = _mm256_cmpeq_epi8(v, _mm256_set1_epi8(static_cast<char>(k)));
+  return static_cast<std::uint32_t>(_mm256_movemask_epi8(eq));
+}
+#else
+inline constexpr std::size_t tag_lanes = 16;
+
+inline std::uint32_t match_lanes(const std::uint8_t* p, std::uint8_t k) {
+  __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+  __m128i eq = _mm_cmpeq_epi8(v, _mm_set1_epi8(static_cast<char>(k)));
+  return static_cast<std::uint32_t>(_mm_movemask_epi8(eq));
+}
+#endif
+#endif
+
+template <class Tag>
+std::size_t count_tags(const Tag* tags, std::size_t first, std::size_t n,
+                       Tag k) {
+#ifdef VV3_SIMD_TAG_SCAN
+  if constexpr (sizeof(Tag) == 1) {
+    const auto* p = reinterpret_cast<const std::uint8_t*>(tags);
+    std::size_t count = 0;
+    std::size_t i = first;
+    for (; i + tag_lanes <= n; i += tag_lanes) {
+      count += std::popcount(match_lanes(p + i, k));
+    }
+    return count + count_tags_scalar(tags, i, n, k);
+  }
+#endif
+  return count_tags_scalar(tags, first, n, k);
+}
+
+template <class Tag>
+std::size_t find_tag(const Tag* tags, std::size_t first, std::size_t n,
+                     Tag k) {
+#ifdef VV3_SIMD_TAG_SCAN
+  if constexpr (sizeof(Tag) == 1) {
+    const auto* p = reinterpret_cast<const std::uint8_t*>(tags);
+    std::size_t i = first;
+    for (; i + tag_lanes <= n; i += tag_lanes) {
+      if (std::uint32_t m = match_lanes(p + i, k)) {
+        return i + std::countr_zero(m);
+      }
+    }
+    return find_tag_scalar(tags, i, n, k);
+  }
+#endif
+  return find_tag_scalar(tags, first, n, k);
+}
+
+template <class Tag>
+void mask_tags(const Tag* tags, std::size_t n, Tag k, std::uint64_t* out) {
+#ifdef VV3_SIMD_TAG_SCAN
+  if constexpr (sizeof(Tag) == 1) {
+    const auto* p = reinterpret_cast<const std::uint8_t*>(tags);
+    // tag_lanes divides 64, so a block never straddles two output words
+    std::size_t i = 0;
+    for (; i + tag_lanes <= n; i += tag_lanes) {
+      out[i / 64] |= std::uint64_t{match_lanes(p + i, k)} << (i % 64);
+    }
+    mask_tags_scalar(tags, i, n, k, out);
+    return;
+  }
+#endif
+  mask_tags_scalar(tags, 0, n, k, out);
+}
+
+} // namespace detail
+
+// types that can be moved to a new address with memcpy, leaving nothing to
+// destroy at the old one. trivially copyable types always qualify; specialize
+// this for others that do (e.g. types holding only owning pointers)
+template <class T>
+struct is_trivially_relocatable : std::is_trivially_copyable<T> {};
+
+template <class T>
+inline constexpr bool is_trivially_relocatable_v =
+    is_trivially_relocatable<T>::value;
+
 template <class U> void destroy_impl(std::byte* const p) {
   reinterpret_cast<U*>(p)->~U();
 }
@@ -35,24 +234,194 @@ void move_impl(std::byte* const loc, const std::byte* const p) {
   ::new (loc) U(std::move(*reinterpret_cast<U*>(const_cast<std::byte*>(p))));
 }
 
-template <class... Types> class vector {
+template <class U, class R, class F> R visit_impl(F& f, std::byte* const p) {
+  return std::invoke(f, *reinterpret_cast<U*>(p));
+}
+
+// per-alternative lookups shared by basic_vector and the other layouts, all
+// indexed by tag
+namespace detail {
+
+template <class T, class...> struct first {
+  using type = T;
+};
+
+template <class... Types> using first_t = typename first<Types...>::type;
+
+// position of U among T, TN..., ignoring cv and references
+template <std::size_t I, class U, class T, class... TN>
+[[nodiscard]] constexpr std::size_t find_type_index() {
+  if constexpr (std::is_same_v<std::decay_t<U>, std::decay_t<T>>) {
+    return I;
+  } else {
+    return find_type_index<I + 1, U, TN...>();
+  }
+}
+
+using dtor_fptr_t = void (*)(std::byte* const);
+using cm_fptr_t = void (*)(std::byte* const, const std::byte* const);
+
+template <class... Types>
+inline constexpr dtor_fptr_t dtable[]{destroy_impl<Types>...};
+
+// move-only alternatives get no copy; containers holding them aren't copyable
+template <class U> [[nodiscard]] constexpr cm_fptr_t copy_fptr() {
+  if constexpr (std::is_copy_constructible_v<U>) {
+    return copy_impl<U>;
+  } else {
+    return nullptr;
+  }
+}
+
+template <class... Types>
+inline constexpr cm_fptr_t ctable[]{copy_fptr<Types>()...};
+
+template <class... Types>
+inline constexpr cm_fptr_t mtable[]{move_impl<Types>...};
+
+// size and alignment only depend on the alternative, so they are looked up by
+// tag rather than stored per element
+template <class... Types>
+inline constexpr std::size_t size_table[]{sizeof(Types)...};
+
+template <class... Types>
+inline constexpr std::size_t align_table[]{alignof(Types)...};
+
+// visitors return the same type for every alternative, so the first one's
+// decides it
+template <class F, class... Types>
+using visit_result_t = std::invoke_result_t<F&, first_t<Types...>&>;
+
+template <class F, class... Types>
+inline constexpr visit_result_t<F, Types...> (*vtable[])(F&,
+                                                         std::byte* const){
+    visit_impl<Types, visit_result_t<F, Types...>, F>...};
+
+} // namespace detail
+
+// walks a tightly laid out payload front to back from the tags alone: each
+// element starts at the end of the previous one plus its alignment padding.
+// `offset` is where the element before `tag` ended
+template <class... Types> class sequential_iterator {
+public:
+  using tag_type = tag_for_t<sizeof...(Types)>;
+  using iterator_concept = std::forward_iterator_tag;
+  using iterator_category = std::input_iterator_tag;
+  using value_type = Element<tag_type>;
+  using difference_type = std::ptrdiff_t;
+
+  sequential_iterator() = default;
+
+  sequential_iterator(const tag_type* tag, std::byte* data, std::size_t offset)
+      : tag(tag), data(data), offset(offset) {}
+
+  [[nodiscard]] value_type operator*() const {
+    return {*tag, data + start()};
+  }
+
+  sequential_iterator& operator++() {
+    offset = start() + size_table[*tag];
+    ++tag;
+    return *this;
+  }
+
+  sequential_iterator operator++(int) {
+    sequential_iterator tmp = *this;
+    ++*this;
+    return tmp;
+  }
+
+  [[nodiscard]] bool operator==(const sequential_iterator& rhs) const {
+    return tag == rhs.tag;
+  }
+
+private:
+  static constexpr auto& size_table = detail::size_table<Types...>;
+  static constexpr auto& align_table = detail::align_table<Types...>;
+
+  // padding is only applied on use, so the end iterator never reads the tag
+  // one past the last element
+  [[nodiscard]] std::size_t start() const {
+    return offset + get_padding(offset, align_table[*tag]);
+  }
+
+  const tag_type* tag = nullptr;
+  std::byte* data = nullptr;
+  std::size_t offset = 0;
+};
+
+// everything lives in one block obtained from `Alloc` (rebound as needed), so
+// vectors can live in arenas or std::pmr memory resources:
+//
+//   [header][tags: entries][offsets: entries * offset_width][payload: capacity]
+//
+// (offset_width is 0 when all alternatives share one size and alignment:
+// element i is then at i * sizeof, see constant_stride)
+//
+// the vector itself is just the allocator and a pointer to the block, which is
+// null until the first reservation (or points at an inline buffer, see
+// small_vector)
+template <std::size_t InlineBytes, class... Types> class small_vector;
+
+template <class Alloc, class... Types> class basic_vector {
+  static constexpr std::size_t N = sizeof...(Types);
+
 public:
-  vector();
+  // tags are chosen at compile time as the narrowest unsigned type fitting N
+  using tag_type = tag_for_t<N>;
+  using element_type = Element<tag_type>;
+  using allocator_type = Alloc;
+
+  basic_vector() : basic_vector(Alloc()) {}
 
-  ~vector();
+  explicit basic_vector(const Alloc& alloc);
 
-  vector(const vector& rhs);
+  ~basic_vector();
 
-  vector(vector&& rhs);
+  basic_vector(const basic_vector& rhs)
+    requires(std::is_copy_constructible_v<Types> && ...);
 
-  vector& operator=(const vector& rhs);
+  basic_vector(basic_vector&& rhs) noexcept;
 
-  vector& operator=(vector&& rhs);
+  // a small_vector may still hold its elements inline, and moving those out
+  // allocates, so this can't be noexcept like the move above
+  template <std::size_t InlineBytes>
+    requires std::is_same_v<Alloc, std::allocator<std::byte>>
+  basic_vector(small_vector<InlineBytes, Types...>&& rhs);
+
+  basic_vector& operator=(const basic_vector& rhs)
+    requires(std::is_copy_constructible_v<Types> && ...);
+
+  basic_vector& operator=(basic_vector&& rhs);
 
   void reserve_entries(std::size_t new_entries);
 
   void reserve_cap(std::size_t new_cap);
 
+  // room for `count` elements and `bytes` bytes of elements plus padding, in
+  // at most one allocation. appends that stay within both never regrow
+  void reserve(std::size_t count, std::size_t bytes);
+
+  // upper bound on the payload taken by counts[i] elements of Ts[i] in any
+  // order: each element pads by at most alignof - 1
+  template <class... Ts>
+  [[nodiscard]] static constexpr std::size_t
+  worst_case_bytes(std::conditional_t<true, std::size_t, Ts>... counts) {
+    return ((counts * (sizeof(Ts) + alignof(Ts) - 1)) + ... + 0);
+  }
+
+  // reserve() for counts[i] elements of Ts[i], e.g.
+  // reserve_for<int, std::string>(100, 10)
+  template <class... Ts>
+  void reserve_for(std::conditional_t<true, std::size_t, Ts>... counts) {
+    reserve((counts + ... + 0), worst_case_bytes<Ts...>(counts...));
+  }
+
+  // gives back unused entries and payload: the block is reallocated to fit the
+  // current contents, which also picks the narrowest offset width that fits.
+  // inline storage is left alone
+  void shrink_to_fit();
+
   template <class U> void push_back(const U& u);
 
 private:
@@ -64,263 +433,1054 @@ private:
 public:
   template <class U> void push_back(rval_ref<U> u);
 
-  [[nodiscard]] Element operator[](std::size_t index);
+  // constructs the element directly at its final, aligned offset
+  template <class U, class... Args> U& emplace_back(Args&&... args);
+
+  template <class U, class... Args>
+  U& emplace_back(std::in_place_type_t<U>, Args&&... args);
+
+  // inserts before element `index`. the elements after it move up to where
+  // appending them after the new one would have put them
+  template <class U> void insert(std::size_t index, U&& u) {
+    emplace<std::decay_t<U>>(index, std::forward<U>(u));
+  }
+
+  template <class U, class... Args>
+  U& emplace(std::size_t index, Args&&... args);
+
+  void pop_back();
+
+  // destroys every element but keeps the block for reuse
+  void clear() noexcept;
+
+  void erase(std::size_t index) { erase(index, index + 1); }
+
+  // destroys [first, last) and moves the elements after it down to where
+  // appending them after element first - 1 would have put them
+  void erase(std::size_t first, std::size_t last);
+
+  // erases every element whose bit is set, in the layout of type_mask(), in a
+  // single pass that also packs the survivors tightly. returns how many were
+  // erased
+  std::size_t erase_mask(const std::vector<std::uint64_t>& mask);
+
+  [[nodiscard]] element_type operator[](std::size_t index);
 
   template <class U> [[nodiscard]] U& get(std::size_t index);
 
-  [[nodiscard]] std::size_t size() const noexcept { return size_; }
+  // calls `f` with a correctly typed reference to element `index`, dispatching
+  // through a table of function pointers the same way dtable/ctable/mtable do.
+  // `f` has to return the same type for every alternative
+  template <class F> decltype(auto) visit(std::size_t index, F&& f);
+
+  // visit() for every element, in order
+  template <class F> void for_each(F&& f);
+
+  // number of elements holding `T`, a SIMD compare over the tag array
+  template <class T> [[nodiscard]] std::size_t count_type() const;
+
+  // first element at or after `from` holding `T`, or size() if there is none
+  template <class T>
+  [[nodiscard]] std::size_t find_type(std::size_t from = 0) const;
+
+  // bit i % 64 of word i / 64 is set iff element i holds `T`
+  template <class T> [[nodiscard]] std::vector<std::uint64_t> type_mask() const;
+
+  [[nodiscard]] std::size_t size() const noexcept {
+    return block ? block->size : 0;
+  }
+
+  // bytes taken by the elements themselves
+  [[nodiscard]] std::size_t payload_bytes() const noexcept;
+
+  // bytes skipped between elements to align them
+  [[nodiscard]] std::size_t padding_bytes() const noexcept {
+    return payload_end() - payload_bytes();
+  }
+
+  // bytes of the block spent on the header, tags and offsets
+  [[nodiscard]] std::size_t metadata_bytes() const noexcept {
+    return block ? block->payload_at : 0;
+  }
+
+  // rebuilds the vector in an exactly sized block with every element, in
+  // order, at the first suitably aligned offset after the previous one, which
+  // drops any slack between elements. inline storage is left alone
+  void compact();
+
+  // compact(), but first stably groups elements by alignment, strictest first,
+  // which leaves no padding at all. element i of the result is element
+  // order[i] of the vector before the call
+  std::vector<std::size_t> compact_by_alignment();
+
+  // bytes used per entry by the offsets array, the narrowest of 1/2/4/8 that
+  // can address the current capacity. 0 if the vector has a constant stride
+  [[nodiscard]] std::size_t offset_width() const noexcept {
+    return block ? block->offset_width : width_for(0);
+  }
+
+  [[nodiscard]] allocator_type get_allocator() const noexcept { return alloc; }
+
+  // walks the payload front to back without touching the offsets array
+  using iterator = sequential_iterator<Types...>;
+
+  [[nodiscard]] iterator begin() {
+    return block ? iterator(type_index(), data(), 0) : iterator();
+  }
+
+  [[nodiscard]] iterator end() {
+    return block ? iterator(type_index() + block->size, data(), 0)
+                 : iterator();
+  }
+
+protected:
+  // the payload starts max_align-aligned, so an element's padding only depends
+  // on its offset and relocation never has to recompute offsets
+  static constexpr std::size_t max_align = std::max({alignof(Types)...});
+
+  struct header {
+    std::size_t size;
+    std::size_t entries;
+    std::size_t capacity;
+    std::size_t offsets_at; // byte offset of the offsets region in the block
+    std::size_t payload_at; // byte offset of the payload region in the block
+    // block to fall back to once storage is released: an inline buffer (which
+    // points at itself) or null
+    header* home;
+    std::uint8_t offset_width;
+  };
+
+  // the block is allocated in whole units, which makes any allocator
+  // (including a polymorphic_allocator over an arbitrary resource) return it
+  // aligned for both the header and the payload
+  static constexpr std::size_t block_align =
+      std::max(max_align, alignof(header));
+
+  // starts out with a block laid out inside `buffer`, which must be
+  // block_align-aligned, outlive the vector and hold at least a header
+  basic_vector(const Alloc& alloc, std::byte* buffer, std::size_t bytes);
+
+  [[nodiscard]] bool is_inline() const noexcept {
+    return block && block->home == block;
+  }
 
 private:
-  static constexpr std::size_t N = sizeof...(Types);
-  using dtor_fptr_t = void (*)(std::byte* const);
-  using cm_fptr_t = void (*)(std::byte* const, const std::byte* const);
+  using cm_fptr_t = detail::cm_fptr_t;
 
-  static constexpr dtor_fptr_t dtable[N]{destroy_impl<Types>...};
-  static constexpr cm_fptr_t ctable[N]{copy_impl<Types>...};
-  static constexpr cm_fptr_t mtable[N]{move_impl<Types>...};
+  static constexpr auto& dtable = detail::dtable<Types...>;
+  static constexpr auto& ctable = detail::ctable<Types...>;
+  static constexpr auto& mtable = detail::mtable<Types...>;
 
-  std::size_t size_;
-  std::size_t capacity;
-  std::size_t entries;
+  template <class F>
+  using visit_result_t = detail::visit_result_t<F, Types...>;
 
-  std::byte* data;
-  std::size_t* offsets;
-  std::size_t* type_size;
-  std::size_t* type_index;
-  std::size_t* type_align;
+  template <class F>
+  static constexpr auto& vtable = detail::vtable<F, Types...>;
+
+  static constexpr auto& size_table = detail::size_table<Types...>;
+  static constexpr auto& align_table = detail::align_table<Types...>;
+
+  static constexpr bool trivially_relocatable =
+      (is_trivially_relocatable_v<Types> && ...);
+  static constexpr bool trivially_copyable =
+      (std::is_trivially_copyable_v<Types> && ...);
+  static constexpr bool trivially_destructible =
+      (std::is_trivially_destructible_v<Types> && ...);
+
+  // with one size and alignment across all alternatives, element i always
+  // sits at i * stride: no offsets are stored and nothing is ever padded
+  static constexpr std::size_t stride = sizeof(detail::first_t<Types...>);
+  static constexpr bool constant_stride =
+      ((sizeof(Types) == stride &&
+        alignof(Types) == alignof(detail::first_t<Types...>)) &&
+       ...);
+
+  static constexpr std::uint8_t width_for(std::size_t cap) {
+    return constant_stride ? 0 : offset_width_for(cap);
+  }
+
+  static constexpr std::size_t max_size = std::max({sizeof(Types)...});
+
+  struct alignas(block_align) block_unit {
+    std::byte bytes[block_align];
+  };
+
+  using alloc_traits = std::allocator_traits<Alloc>;
+
+  template <class T>
+  using rebind_alloc = typename alloc_traits::template rebind_alloc<T>;
+
+  [[no_unique_address]] Alloc alloc;
+
+  header* block;
+
+  [[nodiscard]] std::size_t entries() const noexcept {
+    return block ? block->entries : 0;
+  }
+
+  [[nodiscard]] std::size_t capacity() const noexcept {
+    return block ? block->capacity : 0;
+  }
+
+  [[nodiscard]] tag_type* type_index() const noexcept {
+    return reinterpret_cast<tag_type*>(block + 1);
+  }
+
+  [[nodiscard]] std::byte* offsets() const noexcept {
+    return reinterpret_cast<std::byte*>(block) + block->offsets_at;
+  }
+
+  [[nodiscard]] std::byte* data() const noexcept {
+    return reinterpret_cast<std::byte*>(block) + block->payload_at;
+  }
+
+  static constexpr std::size_t block_units(std::size_t payload_at,
+                                          std::size_t cap) {
+    return (payload_at + cap + block_align - 1) / block_align;
+  }
+
+  template <class T> [[nodiscard]] T* allocate(std::size_t n);
+
+  template <class T> void deallocate(T* p, std::size_t n);
+
+  [[nodiscard]] std::size_t get_offset(std::size_t index) const {
+    if constexpr (constant_stride) {
+      return index * stride;
+    } else {
+      return load_offset(offsets(), block->offset_width, index);
+    }
+  }
+
+  void set_offset(std::size_t index, std::size_t offset) {
+    if constexpr (!constant_stride) {
+      store_offset(offsets(), block->offset_width, index, offset);
+    }
+  }
+
+  // one past the last payload byte in use
+  [[nodiscard]] std::size_t payload_end() const;
+
+  // moves everything into a single new block laid out for the given entry
+  // count and payload capacity; the only place the vector allocates
+  void regrow(std::size_t new_entries, std::size_t new_cap);
+
+  // frees a heap block, if any, without touching its elements
+  void free_block(header* h);
+
+  // reserves room for one more element of alternative `index`, records its
+  // tag and offset and returns the offset. the caller constructs the object
+  // there and bumps the size
+  std::size_t place_obj(std::size_t index);
 
-  template <std::size_t I, class U, class T, class... TN>
-  [[nodiscard]] std::size_t find_type_index() const;
+  // moves one element of alternative `tag` to another offset of the payload.
+  // the two may overlap, in which case it goes through a temporary
+  void move_element(tag_type tag, std::size_t to, std::size_t from);
 
-  void place_obj(std::size_t index, const std::byte* const p,
-                 cm_fptr_t place_func);
+  // moves elements [first, size()) by `shift` bytes (a multiple of max_align)
+  // and updates their offsets; the tags are left to the caller
+  void shift_down(std::size_t first, std::size_t shift);
 
-  void delete_data();
+  void shift_up(std::size_t first, std::size_t shift);
 
-  void reset();
+  // moves elements [first, size()) down so that each one starts at the first
+  // suitably aligned offset after the end of the one before it, with the
+  // first one placed after `end`. once an element moves by a multiple of
+  // max_align, every later one moves by the same amount, so the rest goes as
+  // a single shift_down()
+  void pack_down(std::size_t first, std::size_t end);
+
+  // `table` is ctable for copies and mtable for element-wise moves between
+  // vectors whose allocators don't compare equal. expects an empty vector
+  void copy_from(const basic_vector& rhs, const cm_fptr_t* table);
+
+  // takes over rhs's heap block, or moves its elements if they are inline.
+  // expects an empty vector
+  void steal(basic_vector& rhs);
+
+  // destroys every element and falls back to the home block, if any
+  void release();
+
+  // rebuilds the vector in a fresh, exactly sized block holding element
+  // order[i] at position i
+  void repack(const std::size_t* order);
+};
+
+template <class... Types>
+using vector = basic_vector<std::allocator<std::byte>, Types...>;
+
+namespace detail {
+
+// lives in a base class so the buffer exists before basic_vector lays its
+// block out in it
+template <std::size_t Bytes, std::size_t Align> struct inline_buffer {
+  alignas(Align) std::byte buffer[Bytes];
 };
 
 template <class... Types>
-vector<Types...>::vector()
-    : size_(0), capacity(0), entries(0), data(nullptr), offsets(nullptr),
-      type_size(nullptr), type_index(nullptr), type_align(nullptr) {}
+inline constexpr std::size_t small_align =
+    std::max({alignof(Types)..., alignof(std::max_align_t)});
+
+} // namespace detail
+
+// keeps tags, offsets and payload in an InlineBytes buffer inside the object
+// until they overflow it, then spills to the usual heap block. InlineBytes
+// includes the block header, so the inline buffer only starts to pay off at a
+// few dozen bytes
+template <std::size_t InlineBytes, class... Types>
+class small_vector
+    : private detail::inline_buffer<InlineBytes,
+                                    detail::small_align<Types...>>,
+      public basic_vector<std::allocator<std::byte>, Types...> {
+  using storage =
+      detail::inline_buffer<InlineBytes, detail::small_align<Types...>>;
+  using base = basic_vector<std::allocator<std::byte>, Types...>;
+
+  static_assert(InlineBytes > sizeof(typename base::header),
+                "inline buffer can't hold a block header");
 
-template <class... Types> vector<Types...>::~vector() { delete_data(); }
+  static constexpr bool nothrow_move =
+      (std::is_nothrow_move_constructible_v<Types> && ...);
 
-// have to set size_ to 0 first, otherwise reserve_entries would access
-// non-owned memory
-template <class... Types> vector<Types...>::vector(const vector& rhs) {
-  reset();                      // bad practice?
-  reserve_entries(rhs.entries); // handles initialization of entries, offsets,
-                                // type_size, type_index, type_align
-  for (std::size_t i = 0; i < rhs.size_; i++) {
-    type_size[i] = rhs.type_size[i];
-    type_index[i] = rhs.type_index[i];
-    type_align[i] = rhs.type_align[i];
-    place_obj(
-        i, rhs.data + rhs.offsets[i],
-        ctable[type_index[i]]); // capacity will automatically grow to handle
-                                // new offsets (if alignment requires it)
+public:
+  small_vector()
+      : storage(), base(std::allocator<std::byte>(), storage::buffer,
+                        InlineBytes) {}
+
+  small_vector(const small_vector& rhs) : small_vector() {
+    base::operator=(rhs);
   }
-}
+
+  // both buffers have the same layout, so moving out of an inline one never
+  // regrows and only the elements' moves can throw
+  small_vector(small_vector&& rhs) noexcept(nothrow_move) : small_vector() {
+    base::operator=(std::move(rhs));
+  }
+
+  small_vector& operator=(const small_vector& rhs) {
+    base::operator=(rhs);
+    return *this;
+  }
+
+  small_vector& operator=(small_vector&& rhs) noexcept(nothrow_move) {
+    base::operator=(std::move(rhs));
+    return *this;
+  }
+
+  // true while the elements still live in the inline buffer
+  [[nodiscard]] bool is_inline() const noexcept { return base::is_inline(); }
+};
+
+namespace pmr {
 
 template <class... Types>
-vector<Types...>::vector(vector&& rhs)
-    : size_(rhs.size_), capacity(rhs.capacity), entries(rhs.entries),
-      data(rhs.data), offsets(rhs.offsets), type_size(rhs.type_size),
-      type_index(rhs.type_index), type_align(rhs.type_align) {
-  rhs.reset();
+using vector =
+    basic_vector<std::pmr::polymorphic_allocator<std::byte>, Types...>;
+
+} // namespace pmr
+
+template <class Alloc, class... Types>
+basic_vector<Alloc, Types...>::basic_vector(const Alloc& alloc)
+    : alloc(alloc), block(nullptr) {}
+
+template <class Alloc, class... Types>
+basic_vector<Alloc, Types...>::basic_vector(const Alloc& alloc,
+                                            std::byte* buffer,
+                                            std::size_t bytes)
+    : alloc(alloc), block(reinterpret_cast<header*>(buffer)) {
+  // guess how many entries the buffer should hold from the average size of an
+  // alternative; whatever is left over goes to the payload
+  constexpr std::size_t avg_size = (sizeof(Types) + ...) / N;
+  constexpr std::size_t per_entry = sizeof(tag_type) + 1 + avg_size;
+  std::size_t slack = sizeof(header) + alignof(std::uint64_t) + max_align;
+  std::size_t new_entries = bytes > slack ? (bytes - slack) / per_entry : 0;
+
+  std::uint8_t width = width_for(0);
+  std::size_t offsets_at = 0;
+  std::size_t payload_at = 0;
+  for (;;) {
+    offsets_at = align_up(sizeof(header) + new_entries * sizeof(tag_type),
+                          alignof(std::uint64_t));
+    payload_at = align_up(offsets_at + new_entries * width, max_align);
+    std::size_t cap = bytes > payload_at ? bytes - payload_at : 0;
+    if (width_for(cap) <= width) {
+      break;
+    }
+    width = width_for(cap);
+  }
+
+  block->size = 0;
+  block->entries = new_entries;
+  block->capacity = bytes > payload_at ? bytes - payload_at : 0;
+  block->offsets_at = offsets_at;
+  block->payload_at = payload_at;
+  block->home = block;
+  block->offset_width = width;
 }
 
-template <class... Types>
-vector<Types...>& vector<Types...>::operator=(const vector& rhs) {
+template <class Alloc, class... Types>
+basic_vector<Alloc, Types...>::~basic_vector() {
+  release();
+}
+
+template <class Alloc, class... Types>
+basic_vector<Alloc, Types...>::basic_vector(const basic_vector& rhs)
+  requires(std::is_copy_constructible_v<Types> && ...)
+    : basic_vector(alloc_traits::select_on_container_copy_construction(
+          rhs.alloc)) {
+  copy_from(rhs, ctable);
+}
+
+template <class Alloc, class... Types>
+basic_vector<Alloc, Types...>::basic_vector(basic_vector&& rhs) noexcept
+    : alloc(std::move(rhs.alloc)), block(nullptr) {
+  steal(rhs);
+}
+
+// the heap-to-heap case only hands the block over, like the move above
+template <class Alloc, class... Types>
+template <std::size_t InlineBytes>
+  requires std::is_same_v<Alloc, std::allocator<std::byte>>
+basic_vector<Alloc, Types...>::basic_vector(
+    small_vector<InlineBytes, Types...>&& rhs)
+    : alloc(rhs.get_allocator()), block(nullptr) {
+  steal(rhs);
+}
+
+template <class Alloc, class... Types>
+basic_vector<Alloc, Types...>&
+basic_vector<Alloc, Types...>::operator=(const basic_vector& rhs)
+  requires(std::is_copy_constructible_v<Types> && ...)
+{
   if (this != &rhs) {
-    delete_data();
-    reset();
-
-    reserve_entries(rhs.entries); // handles initialization of entries, offsets,
-                                  // type_size, type_index, type_align
-    for (std::size_t i = 0; i < rhs.size_; i++) {
-      type_size[i] = rhs.type_size[i];
-      type_index[i] = rhs.type_index[i];
-      type_align[i] = rhs.type_align[i];
-      place_obj(i, rhs.data + rhs.offsets[i],
-                ctable[type_index[i]]); // capacity will automatically grow to
-                                        // handle new offsets (if alignment
-                                        // requires it)
+    release();
+    if constexpr (alloc_traits::propagate_on_container_copy_assignment::value) {
+      alloc = rhs.alloc;
     }
+    copy_from(rhs, ctable);
   }
   return *this;
 }
 
-template <class... Types>
-vector<Types...>& vector<Types...>::operator=(vector&& rhs) {
+template <class Alloc, class... Types>
+basic_vector<Alloc, Types...>&
+basic_vector<Alloc, Types...>::operator=(basic_vector&& rhs) {
   if (this != &rhs) {
-    delete_data();
-    size_ = rhs.size_;
-    capacity = rhs.capacity;
-    entries = rhs.entries;
-    data = rhs.data;
-    offsets = rhs.offsets;
-    type_size = rhs.type_size;
-    type_index = rhs.type_index;
-    type_align = rhs.type_align;
-    rhs.reset();
+    release();
+    if constexpr (alloc_traits::propagate_on_container_move_assignment::value) {
+      alloc = std::move(rhs.alloc);
+      steal(rhs);
+    } else if (alloc == rhs.alloc) {
+      steal(rhs);
+    } else {
+      // memory from rhs can't be freed through our allocator, so move the
+      // elements into storage of our own
+      copy_from(rhs, mtable);
+      rhs.release();
+    }
   }
   return *this;
 }
 
-template <class... Types>
+template <class Alloc, class... Types>
 template <class U>
-void vector<Types...>::push_back(const U& u) {
-  if (size_ == entries) {
-    reserve_entries(2 * entries + 1);
+void basic_vector<Alloc, Types...>::push_back(const U& u) {
+  emplace_back<U>(u);
+}
+
+template <class Alloc, class... Types>
+template <class U>
+void basic_vector<Alloc, Types...>::push_back(rval_ref<U> u) {
+  emplace_back<std::decay_t<U>>(std::move(u));
+}
+
+template <class Alloc, class... Types>
+template <class U, class... Args>
+U& basic_vector<Alloc, Types...>::emplace_back(Args&&... args) {
+  std::size_t offset = place_obj(detail::find_type_index<0, U, Types...>());
+  U* obj = ::new (data() + offset) U(std::forward<Args>(args)...);
+  block->size++;
+  return *obj;
+}
+
+template <class Alloc, class... Types>
+template <class U, class... Args>
+U& basic_vector<Alloc, Types...>::emplace_back(std::in_place_type_t<U>,
+                                               Args&&... args) {
+  return emplace_back<U>(std::forward<Args>(args)...);
+}
+
+template <class Alloc, class... Types>
+template <class U, class... Args>
+U& basic_vector<Alloc, Types...>::emplace(std::size_t index, Args&&... args) {
+  if (index == size()) {
+    return emplace_back<U>(std::forward<Args>(args)...);
   }
 
-  std::size_t index = find_type_index<0, U, Types...>();
+  // built first, so a throwing constructor leaves the vector untouched
+  U value(std::forward<Args>(args)...);
+
+  std::size_t n = size();
+  std::size_t prev_end =
+      index == 0 ? 0
+                 : get_offset(index - 1) + size_table[type_index()[index - 1]];
+  std::size_t at = prev_end + get_padding(prev_end, alignof(U));
+  std::size_t next = get_offset(index);
+  // make room by moving the suffix up by a multiple of max_align, which keeps
+  // its padding, then pull it back down against the new element. the new one
+  // may also just fit in the padding before `next`
+  std::size_t shift =
+      at + sizeof(U) > next ? align_up(at + sizeof(U) - next, max_align) : 0;
 
-  type_size[size_] = sizeof(U);
-  type_index[size_] = index;
-  type_align[size_] = alignof(U);
+  std::size_t new_entries = entries();
+  std::size_t new_cap = capacity();
+  if (n == new_entries) {
+    new_entries = 2 * new_entries + 1;
+  }
+  std::size_t end = payload_end();
+  if (end + shift + 1 > new_cap) {
+    new_cap = std::max(end + shift + 1, new_cap * 2);
+  }
+  if (new_entries != entries() || new_cap != capacity()) {
+    regrow(new_entries, new_cap);
+  }
 
-  place_obj(size_, reinterpret_cast<const std::byte* const>(&u),
-            ctable[type_index[size_]]);
+  shift_up(index, shift);
+  std::memmove(type_index() + index + 1, type_index() + index,
+               (n - index) * sizeof(tag_type));
+  for (std::size_t i = n; i-- > index;) {
+    set_offset(i + 1, get_offset(i));
+  }
+
+  type_index()[index] =
+      static_cast<tag_type>(detail::find_type_index<0, U, Types...>());
+  set_offset(index, at);
+  U* obj = ::new (data() + at) U(std::move(value));
+  block->size++;
+  pack_down(index + 1, at + sizeof(U));
+  return *obj;
 }
 
-template <class... Types>
-template <class U>
-void vector<Types...>::push_back(rval_ref<U> u) {
-  using Udec = std::decay_t<U>;
-  if (size_ == entries) {
-    reserve_entries(2 * entries + 1);
+template <class Alloc, class... Types>
+void basic_vector<Alloc, Types...>::pop_back() {
+  std::size_t last = size() - 1;
+  dtable[type_index()[last]](data() + get_offset(last));
+  block->size--;
+}
+
+template <class Alloc, class... Types>
+void basic_vector<Alloc, Types...>::clear() noexcept {
+  if (!block) {
+    return;
   }
+  if constexpr (!trivially_destructible) {
+    for (std::size_t i = 0; i < block->size; i++) {
+      dtable[type_index()[i]](data() + get_offset(i));
+    }
+  }
+  block->size = 0;
+}
 
-  std::size_t index = find_type_index<0, Udec, Types...>();
+template <class Alloc, class... Types>
+void basic_vector<Alloc, Types...>::erase(std::size_t first,
+                                          std::size_t last) {
+  if (first == last) {
+    return;
+  }
+  if constexpr (!trivially_destructible) {
+    for (std::size_t i = first; i < last; i++) {
+      dtable[type_index()[i]](data() + get_offset(i));
+    }
+  }
 
-  type_size[size_] = sizeof(Udec);
-  type_index[size_] = index;
-  type_align[size_] = alignof(Udec);
+  std::size_t n = size();
+  if (last < n) {
+    std::size_t prev_end =
+        first == 0
+            ? 0
+            : get_offset(first - 1) + size_table[type_index()[first - 1]];
+    pack_down(last, prev_end);
+    std::memmove(type_index() + first, type_index() + last,
+                 (n - last) * sizeof(tag_type));
+    for (std::size_t i = last; i < n; i++) {
+      set_offset(i - (last - first), get_offset(i));
+    }
+  }
+  block->size -= last - first;
+}
 
-  place_obj(size_, reinterpret_cast<const std::byte* const>(&u),
-            mtable[type_index[size_]]);
+template <class Alloc, class... Types>
+std::size_t
+basic_vector<Alloc, Types...>::erase_mask(
+    const std::vector<std::uint64_t>& mask) {
+  std::size_t n = size();
+  std::size_t kept = 0;
+  std::size_t end = 0;
+  for (std::size_t i = 0; i < n; i++) {
+    tag_type t = type_index()[i];
+    std::size_t from = get_offset(i);
+    if (i / 64 < mask.size() && (mask[i / 64] >> (i % 64) & 1)) {
+      dtable[t](data() + from);
+      continue;
+    }
+    // survivors only ever move down, and never onto one not yet visited
+    std::size_t to = end + get_padding(end, align_table[t]);
+    move_element(t, to, from);
+    type_index()[kept] = t;
+    set_offset(kept, to);
+    end = to + size_table[t];
+    kept++;
+  }
+  if (block) {
+    block->size = kept;
+  }
+  return n - kept;
 }
 
-template <class... Types>
-[[nodiscard]] Element vector<Types...>::operator[](std::size_t index) {
+template <class Alloc, class... Types>
+[[nodiscard]] typename basic_vector<Alloc, Types...>::element_type
+basic_vector<Alloc, Types...>::operator[](std::size_t index) {
   return {
-      type_index[index],
-      data + offsets[index],
+      type_index()[index],
+      data() + get_offset(index),
   };
 }
 
-template <class... Types>
+template <class Alloc, class... Types>
 template <class T>
-[[nodiscard]] T& vector<Types...>::get(std::size_t index) {
-  if (type_index[index] != find_type_index<0, T, Types...>()) {
+[[nodiscard]] T& basic_vector<Alloc, Types...>::get(std::size_t index) {
+  if (type_index()[index] != detail::find_type_index<0, T, Types...>()) {
     throw std::bad_cast();
   }
-  return *reinterpret_cast<T*>(data + offsets[index]);
+  return *reinterpret_cast<T*>(data() + get_offset(index));
 }
 
-template <class... Types>
-void vector<Types...>::reserve_entries(std::size_t new_entries) {
-  if (new_entries > entries) {
-    std::size_t* new_offsets = new std::size_t[new_entries];
-    std::size_t* new_type_size = new std::size_t[new_entries];
-    std::size_t* new_types = new std::size_t[new_entries];
-    std::size_t* new_type_align = new std::size_t[new_entries];
-
-    for (std::size_t i = 0; i < size_; i++) {
-      new_offsets[i] = offsets[i];
-      new_type_size[i] = type_size[i];
-      new_types[i] = type_index[i];
-      new_type_align[i] = type_align[i];
-    }
+template <class Alloc, class... Types>
+template <class F>
+decltype(auto) basic_vector<Alloc, Types...>::visit(std::size_t index,
+                                                   F&& f) {
+  using Fn = std::remove_reference_t<F>;
+  static_assert(
+      (std::is_same_v<visit_result_t<Fn>, std::invoke_result_t<Fn&, Types&>> &&
+       ...),
+      "visitor must return the same type for every alternative");
+  return vtable<Fn>[type_index()[index]](f, data() + get_offset(index));
+}
 
-    delete[] offsets;
-    delete[] type_size;
-    delete[] type_index;
-    delete[] type_align;
+template <class Alloc, class... Types>
+template <class F>
+void basic_vector<Alloc, Types...>::for_each(F&& f) {
+  for (std::size_t i = 0; i < size(); i++) {
+    visit(i, f);
+  }
+}
 
-    offsets = new_offsets;
-    entries = new_entries;
-    type_size = new_type_size;
-    type_index = new_types;
-    type_align = new_type_align;
+template <class Alloc, class... Types>
+template <class T>
+[[nodiscard]] std::size_t basic_vector<Alloc, Types...>::count_type() const {
+  constexpr auto k =
+      static_cast<tag_type>(detail::find_type_index<0, T, Types...>());
+  return block ? detail::count_tags(type_index(), 0, size(), k) : 0;
+}
+
+template <class Alloc, class... Types>
+template <class T>
+[[nodiscard]] std::size_t
+basic_vector<Alloc, Types...>::find_type(std::size_t from) const {
+  constexpr auto k =
+      static_cast<tag_type>(detail::find_type_index<0, T, Types...>());
+  return from < size() ? detail::find_tag(type_index(), from, size(), k)
+                       : size();
+}
+
+template <class Alloc, class... Types>
+template <class T>
+[[nodiscard]] std::vector<std::uint64_t>
+basic_vector<Alloc, Types...>::type_mask() const {
+  constexpr auto k =
+      static_cast<tag_type>(detail::find_type_index<0, T, Types...>());
+  std::vector<std::uint64_t> mask((size() + 63) / 64);
+  if (block) {
+    detail::mask_tags(type_index(), size(), k, mask.data());
   }
+  return mask;
 }
 
-template <class... Types>
-void vector<Types...>::reserve_cap(std::size_t new_cap) {
-  if (new_cap > capacity) {
-    std::byte* new_data = new std::byte[new_cap];
-    for (std::size_t i = 0; i < size_; i++) {
-      std::size_t old_offset = offsets[i];
-      if (i > 0) {
-        offsets[i] = offsets[i - 1] + type_size[i - 1];
-      } else {
-        offsets[i] = 0;
+template <class Alloc, class... Types>
+[[nodiscard]] std::size_t
+basic_vector<Alloc, Types...>::payload_bytes() const noexcept {
+  std::size_t bytes = 0;
+  for (std::size_t i = 0; i < size(); i++) {
+    bytes += size_table[type_index()[i]];
+  }
+  return bytes;
+}
+
+template <class Alloc, class... Types>
+void basic_vector<Alloc, Types...>::compact() {
+  std::vector<std::size_t> order(size());
+  std::iota(order.begin(), order.end(), std::size_t{0});
+  repack(order.data());
+}
+
+template <class Alloc, class... Types>
+std::vector<std::size_t> basic_vector<Alloc, Types...>::compact_by_alignment() {
+  std::vector<std::size_t> order(size());
+  std::iota(order.begin(), order.end(), std::size_t{0});
+  // sizes are multiples of alignment, so descending alignment never pads
+  std::stable_sort(order.begin(), order.end(),
+                   [this](std::size_t a, std::size_t b) {
+                     return align_table[type_index()[a]] >
+                            align_table[type_index()[b]];
+                   });
+  repack(order.data());
+  return order;
+}
+
+template <class Alloc, class... Types>
+void basic_vector<Alloc, Types...>::reserve_entries(std::size_t new_entries) {
+  if (new_entries > entries()) {
+    regrow(new_entries, capacity());
+  }
+}
+
+template <class Alloc, class... Types>
+void basic_vector<Alloc, Types...>::reserve_cap(std::size_t new_cap) {
+  if (new_cap > capacity()) {
+    regrow(entries(), new_cap);
+  }
+}
+
+template <class Alloc, class... Types>
+void basic_vector<Alloc, Types...>::reserve(std::size_t count,
+                                            std::size_t bytes) {
+  // place_obj keeps a byte of slack past the last element
+  std::size_t new_entries = std::max(entries(), count);
+  std::size_t new_cap = std::max(capacity(), bytes + 1);
+  if (new_entries != entries() || new_cap != capacity()) {
+    regrow(new_entries, new_cap);
+  }
+}
+
+template <class Alloc, class... Types>
+void basic_vector<Alloc, Types...>::shrink_to_fit() {
+  if (!block || is_inline()) {
+    return;
+  }
+  if (size() == 0) {
+    release();
+    return;
+  }
+  regrow(size(), payload_end() + 1);
+}
+
+template <class Alloc, class... Types>
+template <class T>
+[[nodiscard]] T* basic_vector<Alloc, Types...>::allocate(std::size_t n) {
+  rebind_alloc<T> a(alloc);
+  return std::allocator_traits<rebind_alloc<T>>::allocate(a, n);
+}
+
+template <class Alloc, class... Types>
+template <class T>
+void basic_vector<Alloc, Types...>::deallocate(T* p, std::size_t n) {
+  if (p) {
+    rebind_alloc<T> a(alloc);
+    std::allocator_traits<rebind_alloc<T>>::deallocate(a, p, n);
+  }
+}
+
+template <class Alloc, class... Types>
+[[nodiscard]] std::size_t basic_vector<Alloc, Types...>::payload_end() const {
+  if (size() == 0) {
+    return 0;
+  }
+  std::size_t last = block->size - 1;
+  return get_offset(last) + size_table[type_index()[last]];
+}
+
+template <class Alloc, class... Types>
+void basic_vector<Alloc, Types...>::regrow(std::size_t new_entries,
+                                           std::size_t new_cap) {
+  std::uint8_t width = width_for(new_cap);
+  std::size_t offsets_at =
+      align_up(sizeof(header) + new_entries * sizeof(tag_type),
+               alignof(std::uint64_t));
+  std::size_t payload_at =
+      align_up(offsets_at + new_entries * width, max_align);
+  std::size_t units = block_units(payload_at, new_cap);
+
+  auto* new_block = reinterpret_cast<header*>(allocate<block_unit>(units));
+  new_block->home = block ? block->home : nullptr;
+  new_block->size = size();
+  new_block->entries = new_entries;
+  // hand out the slack from rounding up to whole units, but never more than
+  // `width`-byte offsets can address
+  new_block->capacity = units * block_align - payload_at;
+  if (width > 0 && width < sizeof(std::size_t)) {
+    new_block->capacity = std::min(new_block->capacity,
+                                   std::size_t{1} << (8 * width));
+  }
+  new_block->offsets_at = offsets_at;
+  new_block->payload_at = payload_at;
+  new_block->offset_width = width;
+
+  if (block) {
+    std::size_t n = block->size;
+    auto* new_bytes = reinterpret_cast<std::byte*>(new_block);
+    std::byte* new_offsets = new_bytes + offsets_at;
+    std::byte* new_data = new_bytes + payload_at;
+
+    std::memcpy(new_block + 1, type_index(), n * sizeof(tag_type));
+    if (new_block->offset_width == block->offset_width) {
+      std::memcpy(new_offsets, offsets(), n * block->offset_width);
+    } else {
+      for (std::size_t i = 0; i < n; i++) {
+        store_offset(new_offsets, new_block->offset_width, i, get_offset(i));
       }
-      std::uintptr_t addr = reinterpret_cast<std::uintptr_t>(data + offsets[i]);
-      offsets[i] += get_padding(addr, type_align[i]);
-      mtable[type_index[i]](new_data + offsets[i], data + old_offset);
     }
-    delete[] data;
-    data = new_data;
-    capacity = new_cap;
+
+    if constexpr (trivially_relocatable) {
+      std::memcpy(new_data, data(), payload_end());
+    } else {
+      for (std::size_t i = 0; i < n; i++) {
+        std::size_t offset = get_offset(i);
+        mtable[type_index()[i]](new_data + offset, data() + offset);
+        dtable[type_index()[i]](data() + offset);
+      }
+    }
+    free_block(block);
   }
+  block = new_block;
 }
 
-template <class... Types>
-template <std::size_t I, class U, class T, class... TN>
-[[nodiscard]] std::size_t vector<Types...>::find_type_index() const {
-  if constexpr (std::is_same_v<std::decay_t<U>, std::decay_t<T>>) {
-    return I;
+template <class Alloc, class... Types>
+void basic_vector<Alloc, Types...>::free_block(header* h) {
+  if (h && h->home != h) {
+    deallocate(reinterpret_cast<block_unit*>(h),
+               block_units(h->payload_at, h->capacity));
+  }
+}
+
+template <class Alloc, class... Types>
+std::size_t basic_vector<Alloc, Types...>::place_obj(std::size_t index) {
+  std::size_t offset = 0;
+  if constexpr (constant_stride) {
+    offset = size() * stride;
   } else {
-    return find_type_index<I + 1, U, TN...>();
+    offset = payload_end();
+    offset += get_padding(offset, align_table[index]);
   }
+
+  // entries and payload grow together, so a push_back that needs both still
+  // costs a single allocation
+  std::size_t new_entries = entries();
+  std::size_t new_cap = capacity();
+  if (size() == new_entries) {
+    new_entries = 2 * new_entries + 1;
+  }
+  if (offset + size_table[index] + 1 > new_cap) {
+    new_cap = std::max(offset + size_table[index] + 1, new_cap * 2);
+  }
+  if (new_entries != entries() || new_cap != capacity()) {
+    regrow(new_entries, new_cap);
+  }
+
+  set_offset(block->size, offset);
+  type_index()[block->size] = static_cast<tag_type>(index);
+  return offset;
 }
 
-template <class... Types>
-void vector<Types...>::place_obj(std::size_t index, const std::byte* const p,
-                                 cm_fptr_t place_func) {
-  if (index > 0) {
-    offsets[index] = offsets[index - 1] + type_size[index - 1];
+template <class Alloc, class... Types>
+void basic_vector<Alloc, Types...>::move_element(tag_type tag, std::size_t to,
+                                                 std::size_t from) {
+  if (to == from) {
+    return;
+  }
+  std::byte* dst = data() + to;
+  std::byte* src = data() + from;
+  if constexpr (trivially_relocatable) {
+    std::memmove(dst, src, size_table[tag]);
+  } else if ((to < from ? from - to : to - from) >= size_table[tag]) {
+    mtable[tag](dst, src);
+    dtable[tag](src);
+  } else {
+    alignas(max_align) std::byte tmp[max_size];
+    mtable[tag](tmp, src);
+    dtable[tag](src);
+    mtable[tag](dst, tmp);
+    dtable[tag](tmp);
+  }
+}
+
+template <class Alloc, class... Types>
+void basic_vector<Alloc, Types...>::shift_down(std::size_t first,
+                                               std::size_t shift) {
+  std::size_t n = size();
+  if (shift == 0 || first == n) {
+    return;
+  }
+  if constexpr (trivially_relocatable) {
+    std::size_t from = get_offset(first);
+    std::memmove(data() + from - shift, data() + from, payload_end() - from);
+  } else {
+    for (std::size_t i = first; i < n; i++) {
+      move_element(type_index()[i], get_offset(i) - shift, get_offset(i));
+    }
+  }
+  for (std::size_t i = first; i < n; i++) {
+    set_offset(i, get_offset(i) - shift);
+  }
+}
+
+template <class Alloc, class... Types>
+void basic_vector<Alloc, Types...>::pack_down(std::size_t first,
+                                              std::size_t end) {
+  std::size_t n = size();
+  for (std::size_t i = first; i < n; i++) {
+    tag_type t = type_index()[i];
+    std::size_t from = get_offset(i);
+    std::size_t to = end + get_padding(end, align_table[t]);
+    if ((from - to) % max_align == 0) {
+      shift_down(i, from - to);
+      return;
+    }
+    move_element(t, to, from);
+    set_offset(i, to);
+    end = to + size_table[t];
+  }
+}
+
+template <class Alloc, class... Types>
+void basic_vector<Alloc, Types...>::shift_up(std::size_t first,
+                                             std::size_t shift) {
+  std::size_t n = size();
+  if (shift == 0 || first == n) {
+    return;
+  }
+  if constexpr (trivially_relocatable) {
+    std::size_t from = get_offset(first);
+    std::memmove(data() + from + shift, data() + from, payload_end() - from);
+  } else {
+    for (std::size_t i = n; i-- > first;) {
+      move_element(type_index()[i], get_offset(i) + shift, get_offset(i));
+    }
+  }
+  for (std::size_t i = first; i < n; i++) {
+    set_offset(i, get_offset(i) + shift);
+  }
+}
+
+// offsets and tags are copied as-is, so every element lands at the offset it
+// had in rhs and no padding is recomputed
+template <class Alloc, class... Types>
+void basic_vector<Alloc, Types...>::copy_from(const basic_vector& rhs,
+                                              const cm_fptr_t* table) {
+  if (rhs.size() == 0) {
+    return;
+  }
+  if (entries() < rhs.block->size || capacity() < rhs.payload_end()) {
+    regrow(rhs.block->size, rhs.payload_end());
+  }
+
+  std::size_t n = rhs.block->size;
+  std::memcpy(type_index(), rhs.type_index(), n * sizeof(tag_type));
+  if (block->offset_width == rhs.block->offset_width) {
+    std::memcpy(offsets(), rhs.offsets(), n * block->offset_width);
+  } else {
+    for (std::size_t i = 0; i < n; i++) {
+      set_offset(i, rhs.get_offset(i));
+    }
+  }
+
+  if constexpr (trivially_copyable) {
+    std::memcpy(data(), rhs.data(), rhs.payload_end());
+    block->size = n;
   } else {
-    offsets[index] = 0;
+    // size only counts constructed elements in case a copy throws
+    for (; block->size < n; block->size++) {
+      std::size_t offset = get_offset(block->size);
+      table[type_index()[block->size]](data() + offset, rhs.data() + offset);
+    }
   }
+}
 
-  std::uintptr_t addr = reinterpret_cast<std::uintptr_t>(data + offsets[size_]);
-  offsets[size_] += get_padding(addr, type_align[size_]);
+template <class Alloc, class... Types>
+void basic_vector<Alloc, Types...>::steal(basic_vector& rhs) {
+  if (rhs.is_inline()) {
+    copy_from(rhs, mtable);
+    rhs.release();
+    return;
+  }
 
-  std::size_t new_cap = offsets[size_] + type_size[size_] + 1;
-  if (new_cap > capacity) {
-    reserve_cap(std::max(new_cap, capacity * 2));
+  header* own_home = block ? block->home : nullptr;
+  header* rhs_home = rhs.block ? rhs.block->home : nullptr;
+  if (rhs.block) {
+    free_block(block);
+    block = rhs.block;
+    block->home = own_home;
+  }
+  rhs.block = rhs_home;
+  if (rhs_home) {
+    rhs_home->size = 0;
   }
-  place_func(data + offsets[index], p);
-  size_++;
 }
 
-template <class... Types> void vector<Types...>::delete_data() {
-  for (std::size_t i = 0; i < size_; i++) {
-    dtable[type_index[i]](data + offsets[i]);
+template <class Alloc, class... Types>
+void basic_vector<Alloc, Types...>::repack(const std::size_t* order) {
+  if (!block || is_inline()) {
+    return;
+  }
+  std::size_t n = size();
+  if (n == 0) {
+    release();
+    return;
   }
-  delete[] data;
-  delete[] offsets;
-  delete[] type_size;
-  delete[] type_index;
-  delete[] type_align;
+
+  std::size_t end = 0;
+  for (std::size_t i = 0; i < n; i++) {
+    tag_type t = type_index()[order[i]];
+    end += get_padding(end, align_table[t]) + size_table[t];
+  }
+
+  // place_obj keeps a byte of slack past the last element
+  basic_vector packed(alloc);
+  packed.regrow(n, end + 1);
+  for (std::size_t i = 0; i < n; i++) {
+    tag_type t = type_index()[order[i]];
+    std::size_t offset = packed.place_obj(t);
+    std::byte* from = data() + get_offset(order[i]);
+    if constexpr (trivially_relocatable) {
+      std::memcpy(packed.data() + offset, from, size_table[t]);
+    } else {
+      mtable[t](packed.data() + offset, from);
+    }
+    packed.block->size++;
+  }
+
+  if constexpr (trivially_relocatable) {
+    // the bytes now belong to `packed`, there is nothing left to destroy
+    block->size = 0;
+  }
+  release();
+  steal(packed);
 }
 
-template <class... Types> void vector<Types...>::reset() {
-  size_ = 0;
-  capacity = 0;
-  entries = 0;
-  data = nullptr;
-  offsets = nullptr;
-  type_size = nullptr;
-  type_index = nullptr;
-  type_align = nullptr;
+template <class Alloc, class... Types>
+void basic_vector<Alloc, Types...>::release() {
+  if (!block) {
+    return;
+  }
+  if constexpr (!trivially_destructible) {
+    for (std::size_t i = 0; i < block->size; i++) {
+      dtable[type_index()[i]](data() + get_offset(i));
+    }
+  }
+  header* home = block->home;
+  free_block(block);
+  block = home;
+  if (block) {
+    block->size = 0;
+  }
 }
 
 } // namespace vv3
@@ -0,0 +1,340 @@
+#pragma once
+
+#include "vv3.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <memory_resource>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// vv3::vector that keeps alternatives larger than `Threshold` bytes out of
+// line. those are stored as a boxed<T> (a pointer into memory obtained from
+// the vector's allocator) so the contiguous buffer only holds small elements:
+// growing it relocates a pointer per big element instead of the element, and
+// scans over the small alternatives keep their cache density. with a
+// pmr::hybrid_vector over a pool resource the big elements come from the
+// pool's size-segregated free lists
+namespace vv3 {
+
+// owning pointer to one out-of-line T, allocated through `Alloc`
+template <class T, class Alloc> class boxed {
+  using alloc_type =
+      typename std::allocator_traits<Alloc>::template rebind_alloc<T>;
+  using traits = std::allocator_traits<alloc_type>;
+
+public:
+  template <class... Args>
+  boxed(const alloc_type& alloc, std::in_place_t, Args&&... args);
+
+  // a copy has to be boxed through the allocator of the vector it ends up in,
+  // which only basic_hybrid_vector knows
+  boxed(const boxed&) = delete;
+
+  // keeps rhs's allocator: only used to move a box within one vector
+  boxed(boxed&& rhs) noexcept
+      : ptr(std::exchange(rhs.ptr, nullptr)), alloc(rhs.alloc) {}
+
+  // elements are never assigned in place by the vector
+  boxed& operator=(const boxed&) = delete;
+  boxed& operator=(boxed&&) = delete;
+
+  ~boxed();
+
+  [[nodiscard]] T& get() const noexcept { return *ptr; }
+
+private:
+  // first, so a box can be opened without knowing T (see unbox)
+  T* ptr;
+  [[no_unique_address]] alloc_type alloc;
+};
+
+// the box is a pointer (and maybe an allocator handle), so it relocates with
+// memcpy whatever T is
+template <class T, class Alloc>
+struct is_trivially_relocatable<boxed<T, Alloc>> : std::true_type {};
+
+template <class T> struct is_boxed : std::false_type {};
+
+template <class T, class Alloc>
+struct is_boxed<boxed<T, Alloc>> : std::true_type {};
+
+template <class T, class Alloc>
+template <class... Args>
+boxed<T, Alloc>::boxed(const alloc_type& alloc, std::in_place_t,
+                       Args&&... args)
+    : ptr(nullptr), alloc(alloc) {
+  ptr = traits::allocate(this->alloc, 1);
+  try {
+    traits::construct(this->alloc, ptr, std::forward<Args>(args)...);
+  } catch (...) {
+    traits::deallocate(this->alloc, ptr, 1);
+    throw;
+  }
+}
+
+template <class T, class Alloc> boxed<T, Alloc>::~boxed() {
+  static_assert(std::is_standard_layout_v<boxed>);
+  if (ptr) {
+    traits::destroy(alloc, ptr);
+    traits::deallocate(alloc, ptr, 1);
+  }
+}
+
+template <std::size_t Threshold, class Alloc, class... Types>
+class basic_hybrid_vector {
+  static constexpr std::size_t N = sizeof...(Types);
+
+  template <class T>
+  using stored_t = std::conditional_t<(sizeof(T) > Threshold),
+                                      boxed<T, Alloc>, T>;
+
+  using vector_type = basic_vector<Alloc, stored_t<Types>...>;
+
+public:
+  using tag_type = typename vector_type::tag_type;
+  using element_type = typename vector_type::element_type;
+  using allocator_type = Alloc;
+
+  // whether alternative `T` lives in the contiguous buffer
+  template <class T>
+  static constexpr bool is_inline = !(sizeof(T) > Threshold);
+
+  basic_hybrid_vector() = default;
+
+  explicit basic_hybrid_vector(const Alloc& alloc) : vec(alloc) {}
+
+  // copies, and moves between allocators that don't compare equal, rebox
+  // every big element through this vector's allocator
+  basic_hybrid_vector(const basic_hybrid_vector& rhs);
+
+  basic_hybrid_vector(basic_hybrid_vector&& rhs) noexcept = default;
+
+  basic_hybrid_vector& operator=(const basic_hybrid_vector& rhs);
+
+  basic_hybrid_vector& operator=(basic_hybrid_vector&& rhs);
+
+  void reserve_entries(std::size_t new_entries) {
+    vec.reserve_entries(new_entries);
+  }
+
+  // bytes of inline payload; boxed alternatives only take a pointer here
+  void reserve_cap(std::size_t new_cap) { vec.reserve_cap(new_cap); }
+
+  template <class U> void push_back(U&& u) {
+    emplace_back<std::decay_t<U>>(std::forward<U>(u));
+  }
+
+  template <class U, class... Args> U& emplace_back(Args&&... args);
+
+  template <class U, class... Args>
+  U& emplace_back(std::in_place_type_t<U>, Args&&... args) {
+    return emplace_back<U>(std::forward<Args>(args)...);
+  }
+
+  // `data` points at the element itself, inline or not
+  [[nodiscard]] element_type operator[](std::size_t index) {
+    return unbox(vec[index]);
+  }
+
+  template <class U> [[nodiscard]] U& get(std::size_t index);
+
+  template <class F> decltype(auto) visit(std::size_t index, F&& f) {
+    return vec.visit(index, unboxing<F>{f});
+  }
+
+  template <class F> void for_each(F&& f) { vec.for_each(unboxing<F>{f}); }
+
+  template <class T> [[nodiscard]] std::size_t count_type() const {
+    return vec.template count_type<stored_t<T>>();
+  }
+
+  template <class T>
+  [[nodiscard]] std::size_t find_type(std::size_t from = 0) const {
+    return vec.template find_type<stored_t<T>>(from);
+  }
+
+  template <class T> [[nodiscard]] std::vector<std::uint64_t> type_mask() const {
+    return vec.template type_mask<stored_t<T>>();
+  }
+
+  [[nodiscard]] std::size_t size() const noexcept { return vec.size(); }
+
+  [[nodiscard]] allocator_type get_allocator() const noexcept {
+    return vec.get_allocator();
+  }
+
+  class iterator;
+
+  [[nodiscard]] iterator begin() { return iterator(vec.begin()); }
+
+  [[nodiscard]] iterator end() { return iterator(vec.end()); }
+
+private:
+  static constexpr bool boxed_table[N]{is_boxed<stored_t<Types>>::value...};
+
+  // a box is standard layout with the pointer first, so one table lookup and
+  // a load replace a call through a per-type table
+  static element_type unbox(element_type e) {
+    if (boxed_table[e.type_index]) {
+      e.data = *reinterpret_cast<std::byte**>(e.data);
+    }
+    return e;
+  }
+
+  // hands `f` the element rather than its box
+  template <class F> struct unboxing {
+    F& f;
+
+    template <class S> decltype(auto) operator()(S& s) const {
+      if constexpr (is_boxed<S>::value) {
+        return std::invoke(f, s.get());
+      } else {
+        return std::invoke(f, s);
+      }
+    }
+  };
+
+  using alloc_traits = std::allocator_traits<Alloc>;
+
+  // emplace_back()s a copy of every element of rhs, or moves them out if
+  // `Move`. for_each isn't const, but a copy only reads through it
+  template <bool Move> void append_from(basic_hybrid_vector& rhs);
+
+  vector_type vec;
+};
+
+template <std::size_t Threshold, class Alloc, class... Types>
+class basic_hybrid_vector<Threshold, Alloc, Types...>::iterator {
+public:
+  using iterator_concept = std::forward_iterator_tag;
+  using iterator_category = std::input_iterator_tag;
+  using value_type = element_type;
+  using difference_type = std::ptrdiff_t;
+
+  iterator() = default;
+
+  explicit iterator(typename vector_type::iterator it) : it(it) {}
+
+  [[nodiscard]] value_type operator*() const { return unbox(*it); }
+
+  iterator& operator++() {
+    ++it;
+    return *this;
+  }
+
+  iterator operator++(int) {
+    iterator tmp = *this;
+    ++it;
+    return tmp;
+  }
+
+  [[nodiscard]] bool operator==(const iterator& rhs) const {
+    return it == rhs.it;
+  }
+
+private:
+  typename vector_type::iterator it;
+};
+
+template <std::size_t Threshold, class Alloc, class... Types>
+basic_hybrid_vector<Threshold, Alloc, Types...>::basic_hybrid_vector(
+    const basic_hybrid_vector& rhs)
+    : vec(alloc_traits::select_on_container_copy_construction(
+          rhs.get_allocator())) {
+  append_from<false>(const_cast<basic_hybrid_vector&>(rhs));
+}
+
+template <std::size_t Threshold, class Alloc, class... Types>
+basic_hybrid_vector<Threshold, Alloc, Types...>&
+basic_hybrid_vector<Threshold, Alloc, Types...>::operator=(
+    const basic_hybrid_vector& rhs) {
+  if (this != &rhs) {
+    vec.clear();
+    if constexpr (alloc_traits::propagate_on_container_copy_assignment::value) {
+      if (get_allocator() != rhs.get_allocator()) {
+        vec = vector_type(rhs.get_allocator());
+      }
+    }
+    append_from<false>(const_cast<basic_hybrid_vector&>(rhs));
+  }
+  return *this;
+}
+
+template <std::size_t Threshold, class Alloc, class... Types>
+basic_hybrid_vector<Threshold, Alloc, Types...>&
+basic_hybrid_vector<Threshold, Alloc, Types...>::operator=(
+    basic_hybrid_vector&& rhs) {
+  if (this != &rhs) {
+    if (alloc_traits::propagate_on_container_move_assignment::value ||
+        get_allocator() == rhs.get_allocator()) {
+      // the boxes come along with the block
+      vec = std::move(rhs.vec);
+    } else {
+      // boxes from rhs's allocator can't be freed through ours
+      vec.clear();
+      append_from<true>(rhs);
+      rhs.vec.clear();
+      rhs.vec.shrink_to_fit();
+    }
+  }
+  return *this;
+}
+
+template <std::size_t Threshold, class Alloc, class... Types>
+template <bool Move>
+void basic_hybrid_vector<Threshold, Alloc, Types...>::append_from(
+    basic_hybrid_vector& rhs) {
+  vec.reserve_entries(rhs.size());
+  rhs.for_each([this](auto& x) {
+    using U = std::decay_t<decltype(x)>;
+    if constexpr (Move) {
+      emplace_back<U>(std::move(x));
+    } else {
+      emplace_back<U>(std::as_const(x));
+    }
+  });
+}
+
+template <std::size_t Threshold, class Alloc, class... Types>
+template <class U, class... Args>
+U& basic_hybrid_vector<Threshold, Alloc, Types...>::emplace_back(
+    Args&&... args) {
+  if constexpr (is_inline<U>) {
+    return vec.template emplace_back<U>(std::forward<Args>(args)...);
+  } else {
+    return vec
+        .template emplace_back<boxed<U, Alloc>>(
+            vec.get_allocator(), std::in_place, std::forward<Args>(args)...)
+        .get();
+  }
+}
+
+template <std::size_t Threshold, class Alloc, class... Types>
+template <class U>
+[[nodiscard]] U&
+basic_hybrid_vector<Threshold, Alloc, Types...>::get(std::size_t index) {
+  if constexpr (is_inline<U>) {
+    return vec.template get<U>(index);
+  } else {
+    return vec.template get<boxed<U, Alloc>>(index).get();
+  }
+}
+
+template <std::size_t Threshold, class... Types>
+using hybrid_vector =
+    basic_hybrid_vector<Threshold, std::allocator<std::byte>, Types...>;
+
+namespace pmr {
+
+template <std::size_t Threshold, class... Types>
+using hybrid_vector =
+    basic_hybrid_vector<Threshold, std::pmr::polymorphic_allocator<std::byte>,
+                        Types...>;
+
+} // namespace pmr
+
+} // namespace vv3
@@ -0,0 +1,116 @@
+#pragma once
+
+#include "vv3.hpp"
+
+#include <array>
+#include <cstddef>
+#include <span>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// vv3::vector plus a per-alternative list of positions, kept up to date on
+// every append. count<T>() is O(1) and indices_of<T>() / for_each_of<T>() cost
+// time proportional to the number of matches instead of size(), for one extra
+// std::size_t per element
+namespace vv3 {
+
+template <class... Types> class indexed_vector {
+  static constexpr std::size_t N = sizeof...(Types);
+
+public:
+  using tag_type = typename vector<Types...>::tag_type;
+  using element_type = typename vector<Types...>::element_type;
+  using iterator = typename vector<Types...>::iterator;
+
+  void reserve_entries(std::size_t new_entries) {
+    vec.reserve_entries(new_entries);
+  }
+
+  void reserve_cap(std::size_t new_cap) { vec.reserve_cap(new_cap); }
+
+  template <class U> void push_back(U&& u);
+
+  template <class U, class... Args> U& emplace_back(Args&&... args);
+
+  template <class U, class... Args>
+  U& emplace_back(std::in_place_type_t<U>, Args&&... args);
+
+  [[nodiscard]] element_type operator[](std::size_t index) {
+    return vec[index];
+  }
+
+  template <class U> [[nodiscard]] U& get(std::size_t index) {
+    return vec.template get<U>(index);
+  }
+
+  template <class F> decltype(auto) visit(std::size_t index, F&& f) {
+    return vec.visit(index, std::forward<F>(f));
+  }
+
+  template <class F> void for_each(F&& f) { vec.for_each(std::forward<F>(f)); }
+
+  // number of elements holding alternative `T`
+  template <class T> [[nodiscard]] std::size_t count() const noexcept {
+    return positions[detail::find_type_index<0, T, Types...>()].size();
+  }
+
+  // positions of every element holding `T`, ascending. invalidated by the
+  // next append
+  template <class T>
+  [[nodiscard]] std::span<const std::size_t> indices_of() const noexcept {
+    return positions[detail::find_type_index<0, T, Types...>()];
+  }
+
+  // calls f(T&) for every element holding `T`, in order
+  template <class T, class F> void for_each_of(F&& f);
+
+  [[nodiscard]] std::size_t size() const noexcept { return vec.size(); }
+
+  [[nodiscard]] iterator begin() { return vec.begin(); }
+
+  [[nodiscard]] iterator end() { return vec.end(); }
+
+private:
+  vector<Types...> vec;
+  std::array<std::vector<std::size_t>, N> positions;
+};
+
+template <class... Types>
+template <class U>
+void indexed_vector<Types...>::push_back(U&& u) {
+  emplace_back<std::decay_t<U>>(std::forward<U>(u));
+}
+
+template <class... Types>
+template <class U, class... Args>
+U& indexed_vector<Types...>::emplace_back(Args&&... args) {
+  auto& list = positions[detail::find_type_index<0, U, Types...>()];
+  // index first, so a throwing append can be rolled back without leaving an
+  // element the index doesn't know about
+  list.push_back(vec.size());
+  try {
+    return vec.template emplace_back<U>(std::forward<Args>(args)...);
+  } catch (...) {
+    list.pop_back();
+    throw;
+  }
+}
+
+template <class... Types>
+template <class U, class... Args>
+U& indexed_vector<Types...>::emplace_back(std::in_place_type_t<U>,
+                                          Args&&... args) {
+  return emplace_back<U>(std::forward<Args>(args)...);
+}
+
+template <class... Types>
+template <class T, class F>
+void indexed_vector<Types...>::for_each_of(F&& f) {
+  // the tag is known to match, so skip get<T>()'s check
+  for (std::size_t i : positions[detail::find_type_index<0, T, Types...>()]) {
+    std::invoke(f, *reinterpret_cast<T*>(vec[i].data));
+  }
+}
+
+} // namespace vv3
@@ -0,0 +1,173 @@
+#pragma once
+
+#include "vv3.hpp"
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+#include <typeinfo>
+#include <utility>
+#include <vector>
+
+// what vv2 tried, done so it's well defined: elements are packed back to back
+// with no alignment padding, and since they are then generally misaligned
+// they are never accessed in place. load<T> copies one out into a properly
+// aligned T and store<T> copies one back, which compiles to a plain unaligned
+// load/store on x86-64. only trivially copyable alternatives qualify, since
+// elements are moved around as bytes
+namespace vv3 {
+
+template <class... Types> class packed_vector {
+  static constexpr std::size_t N = sizeof...(Types);
+
+  static_assert((std::is_trivially_copyable_v<Types> && ...),
+                "packed_vector copies elements as raw bytes");
+
+public:
+  using tag_type = tag_for_t<N>;
+  // `data` may be misaligned for the element's type: memcpy, don't deref
+  using element_type = Element<tag_type>;
+
+  // offsets are 32 bits, which caps the payload at 4 GiB
+  static constexpr std::size_t max_payload =
+      std::numeric_limits<std::uint32_t>::max();
+
+  // room for `count` elements in `bytes` of payload
+  void reserve(std::size_t count, std::size_t bytes);
+
+  template <class U> void push_back(const U& u) { append(u); }
+
+  template <class U, class... Args> void emplace_back(Args&&... args) {
+    append(U(std::forward<Args>(args)...));
+  }
+
+  template <class U, class... Args>
+  void emplace_back(std::in_place_type_t<U>, Args&&... args) {
+    emplace_back<U>(std::forward<Args>(args)...);
+  }
+
+  [[nodiscard]] element_type operator[](std::size_t index) {
+    return {tags[index], payload.data() + offsets[index]};
+  }
+
+  // a copy of element `index`, which must hold a `T`
+  template <class T> [[nodiscard]] T load(std::size_t index) const;
+
+  // overwrites element `index`, which must hold a `T`
+  template <class T> void store(std::size_t index, const T& t);
+
+  // f is called on an aligned copy of the element, which is written back
+  // afterwards, so f may modify it (but shouldn't keep references to it)
+  template <class F> decltype(auto) visit(std::size_t index, F&& f);
+
+  template <class F> void for_each(F&& f);
+
+  [[nodiscard]] std::size_t size() const noexcept { return tags.size(); }
+
+  // the payload has no padding, so this is just the sum of element sizes
+  [[nodiscard]] std::size_t payload_bytes() const noexcept {
+    return payload.size();
+  }
+
+private:
+  template <class F>
+  using visit_result_t = detail::visit_result_t<F, Types...>;
+
+  template <class T, class R, class F>
+  static R visit_packed(F& f, std::byte* const p) {
+    T t = read<T>(p);
+    if constexpr (std::is_void_v<R>) {
+      std::invoke(f, t);
+      std::memcpy(p, &t, sizeof(T));
+    } else {
+      R r = std::invoke(f, t);
+      std::memcpy(p, &t, sizeof(T));
+      return r;
+    }
+  }
+
+  template <class F>
+  static constexpr visit_result_t<F> (*vtable[N])(F&, std::byte* const){
+      visit_packed<Types, visit_result_t<F>, F>...};
+
+  template <class T> static T read(const std::byte* p) {
+    std::array<std::byte, sizeof(T)> raw;
+    std::memcpy(raw.data(), p, sizeof(T));
+    return std::bit_cast<T>(raw);
+  }
+
+  template <class U> void append(const U& u);
+
+  std::vector<tag_type> tags;
+  std::vector<std::uint32_t> offsets;
+  std::vector<std::byte> payload;
+};
+
+template <class... Types>
+void packed_vector<Types...>::reserve(std::size_t count, std::size_t bytes) {
+  tags.reserve(count);
+  offsets.reserve(count);
+  payload.reserve(bytes);
+}
+
+template <class... Types>
+template <class T>
+[[nodiscard]] T packed_vector<Types...>::load(std::size_t index) const {
+  if (tags[index] != detail::find_type_index<0, T, Types...>()) {
+    throw std::bad_cast();
+  }
+  return read<T>(payload.data() + offsets[index]);
+}
+
+template <class... Types>
+template <class T>
+void packed_vector<Types...>::store(std::size_t index, const T& t) {
+  if (tags[index] != detail::find_type_index<0, T, Types...>()) {
+    throw std::bad_cast();
+  }
+  std::memcpy(payload.data() + offsets[index], &t, sizeof(T));
+}
+
+template <class... Types>
+template <class F>
+decltype(auto) packed_vector<Types...>::visit(std::size_t index, F&& f) {
+  using Fn = std::remove_reference_t<F>;
+  return vtable<Fn>[tags[index]](f, payload.data() + offsets[index]);
+}
+
+template <class... Types>
+template <class F>
+void packed_vector<Types...>::for_each(F&& f) {
+  for (std::size_t i = 0; i < size(); i++) {
+    visit(i, f);
+  }
+}
+
+template <class... Types>
+template <class U>
+void packed_vector<Types...>::append(const U& u) {
+  constexpr std::size_t index = detail::find_type_index<0, U, Types...>();
+
+  std::size_t offset = payload.size();
+  if (offset + sizeof(U) > max_payload) {
+    throw std::length_error("packed_vector: payload is full");
+  }
+
+  payload.resize(offset + sizeof(U));
+  std::memcpy(payload.data() + offset, &u, sizeof(U));
+  try {
+    tags.push_back(static_cast<tag_type>(index));
+    offsets.push_back(static_cast<std::uint32_t>(offset));
+  } catch (...) {
+    tags.resize(offsets.size());
+    payload.resize(offset);
+    throw;
+  }
+}
+
+} // namespace vv3
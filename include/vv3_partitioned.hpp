@@ -0,0 +1,236 @@
+#pragma once
+
+#include "vv3.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <span>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <typeinfo>
+#include <utility>
+#include <vector>
+
+// structure-of-arrays sibling of vv3::vector: every alternative lives in its
+// own std::vector<T>, and a (tag, slot) pair per element keeps the logical
+// order. there is no padding between elements, for_each_of<T> is a plain loop
+// over a T[] the compiler can vectorize, and growing relocates only the array
+// of the alternative being appended. the price is one extra indirection on
+// positional access, and references into an alternative's array are
+// invalidated when that array grows
+namespace vv3 {
+
+template <class... Types> class partitioned_vector {
+  static constexpr std::size_t N = sizeof...(Types);
+
+public:
+  using tag_type = tag_for_t<N>;
+  using slot_type = std::uint32_t;
+  using element_type = Element<tag_type>;
+
+  // per alternative; slots are 32 bits to keep the order map small
+  static constexpr std::size_t max_per_type =
+      std::numeric_limits<slot_type>::max();
+
+  void reserve_entries(std::size_t new_entries);
+
+  // room for `count` elements of alternative `T` without relocating its array
+  template <class T> void reserve(std::size_t count);
+
+  template <class U> void push_back(U&& u) {
+    emplace_back<std::decay_t<U>>(std::forward<U>(u));
+  }
+
+  template <class U, class... Args> U& emplace_back(Args&&... args);
+
+  template <class U, class... Args>
+  U& emplace_back(std::in_place_type_t<U>, Args&&... args) {
+    return emplace_back<U>(std::forward<Args>(args)...);
+  }
+
+  [[nodiscard]] element_type operator[](std::size_t index) {
+    return {tags[index], ltable[tags[index]](arrays, slots[index])};
+  }
+
+  template <class U> [[nodiscard]] U& get(std::size_t index);
+
+  template <class F> decltype(auto) visit(std::size_t index, F&& f);
+
+  // every element in logical order
+  template <class F> void for_each(F&& f);
+
+  // every `T`, in logical order, without touching the order map
+  template <class T, class F> void for_each_of(F&& f);
+
+  template <class T> [[nodiscard]] std::span<T> array_of() {
+    return std::get<index_of<T>>(arrays);
+  }
+
+  template <class T> [[nodiscard]] std::span<const T> array_of() const {
+    return std::get<index_of<T>>(arrays);
+  }
+
+  template <class T> [[nodiscard]] std::size_t count_type() const {
+    return std::get<index_of<T>>(arrays).size();
+  }
+
+  // first element at or after `from` holding `T`, or size() if there is none
+  template <class T>
+  [[nodiscard]] std::size_t find_type(std::size_t from = 0) const;
+
+  [[nodiscard]] std::size_t size() const noexcept { return tags.size(); }
+
+  class iterator;
+
+  [[nodiscard]] iterator begin() { return iterator(this, 0); }
+
+  [[nodiscard]] iterator end() { return iterator(this, size()); }
+
+private:
+  using arrays_type = std::tuple<std::vector<Types>...>;
+  using locate_fptr_t = std::byte* (*)(arrays_type&, slot_type);
+
+  template <class F>
+  using visit_result_t = detail::visit_result_t<F, Types...>;
+
+  template <class F>
+  static constexpr auto& vtable = detail::vtable<F, Types...>;
+
+  template <std::size_t I>
+  static std::byte* locate_impl(arrays_type& arrays, slot_type slot) {
+    return reinterpret_cast<std::byte*>(std::get<I>(arrays).data() + slot);
+  }
+
+  template <std::size_t... I>
+  static constexpr std::array<locate_fptr_t, N>
+  make_ltable(std::index_sequence<I...>) {
+    return {locate_impl<I>...};
+  }
+
+  static constexpr std::array<locate_fptr_t, N> ltable =
+      make_ltable(std::index_sequence_for<Types...>{});
+
+  template <class T>
+  static constexpr std::size_t index_of =
+      detail::find_type_index<0, T, Types...>();
+
+  arrays_type arrays;
+  std::vector<tag_type> tags;
+  std::vector<slot_type> slots; // position inside the alternative's array
+};
+
+template <class... Types> class partitioned_vector<Types...>::iterator {
+public:
+  using iterator_concept = std::forward_iterator_tag;
+  using iterator_category = std::input_iterator_tag;
+  using value_type = element_type;
+  using difference_type = std::ptrdiff_t;
+
+  iterator() = default;
+
+  iterator(partitioned_vector* vec, std::size_t index)
+      : vec(vec), index(index) {}
+
+  [[nodiscard]] value_type operator*() const { return (*vec)[index]; }
+
+  iterator& operator++() {
+    ++index;
+    return *this;
+  }
+
+  iterator operator++(int) {
+    iterator tmp = *this;
+    ++index;
+    return tmp;
+  }
+
+  [[nodiscard]] bool operator==(const iterator& rhs) const {
+    return index == rhs.index;
+  }
+
+private:
+  partitioned_vector* vec = nullptr;
+  std::size_t index = 0;
+};
+
+template <class... Types>
+void partitioned_vector<Types...>::reserve_entries(std::size_t new_entries) {
+  tags.reserve(new_entries);
+  slots.reserve(new_entries);
+}
+
+template <class... Types>
+template <class T>
+void partitioned_vector<Types...>::reserve(std::size_t count) {
+  std::get<index_of<T>>(arrays).reserve(count);
+}
+
+template <class... Types>
+template <class U, class... Args>
+U& partitioned_vector<Types...>::emplace_back(Args&&... args) {
+  constexpr std::size_t index = index_of<U>;
+  auto& array = std::get<index>(arrays);
+  if (array.size() == max_per_type) {
+    throw std::length_error("partitioned_vector: alternative is full");
+  }
+
+  auto slot = static_cast<slot_type>(array.size());
+  array.emplace_back(std::forward<Args>(args)...);
+  // the element first, so a failed metadata push only has to pop it again
+  try {
+    tags.push_back(static_cast<tag_type>(index));
+    slots.push_back(slot);
+  } catch (...) {
+    array.pop_back();
+    tags.resize(slots.size());
+    throw;
+  }
+  return array.back();
+}
+
+template <class... Types>
+template <class T>
+[[nodiscard]] T& partitioned_vector<Types...>::get(std::size_t index) {
+  if (tags[index] != index_of<T>) {
+    throw std::bad_cast();
+  }
+  return std::get<index_of<T>>(arrays)[slots[index]];
+}
+
+template <class... Types>
+template <class F>
+decltype(auto) partitioned_vector<Types...>::visit(std::size_t index, F&& f) {
+  using Fn = std::remove_reference_t<F>;
+  return vtable<Fn>[tags[index]](f, ltable[tags[index]](arrays, slots[index]));
+}
+
+template <class... Types>
+template <class F>
+void partitioned_vector<Types...>::for_each(F&& f) {
+  for (std::size_t i = 0; i < size(); i++) {
+    visit(i, f);
+  }
+}
+
+template <class... Types>
+template <class T, class F>
+void partitioned_vector<Types...>::for_each_of(F&& f) {
+  for (T& t : std::get<index_of<T>>(arrays)) {
+    f(t);
+  }
+}
+
+template <class... Types>
+template <class T>
+[[nodiscard]] std::size_t
+partitioned_vector<Types...>::find_type(std::size_t from) const {
+  constexpr auto k = static_cast<tag_type>(index_of<T>);
+  return from < size() ? detail::find_tag(tags.data(), from, size(), k)
+                       : size();
+}
+
+} // namespace vv3
@@ -0,0 +1,443 @@
+#pragma once
+
+#include "vv3.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <iterator>
+#include <new>
+#include <span>
+#include <type_traits>
+#include <typeinfo>
+#include <utility>
+#include <vector>
+
+// vv3::vector for data that comes in long runs of one alternative. instead
+// of a tag and an offset per element it keeps one (start, offset, tag) entry
+// per run: inside a run elements are packed at a stride of sizeof(T), so
+// positions follow from the run alone. random access binary-searches the
+// runs, iteration steps through them, and for_each/for_each_run dispatch once
+// per run and then loop over a plain T[]
+namespace vv3 {
+
+template <class... Types> class rle_vector {
+  static constexpr std::size_t N = sizeof...(Types);
+
+public:
+  using tag_type = tag_for_t<N>;
+  using element_type = Element<tag_type>;
+
+  rle_vector();
+
+  ~rle_vector();
+
+  rle_vector(const rle_vector& rhs);
+
+  rle_vector(rle_vector&& rhs) noexcept;
+
+  rle_vector& operator=(const rle_vector& rhs);
+
+  rle_vector& operator=(rle_vector&& rhs) noexcept;
+
+  void reserve_cap(std::size_t new_cap);
+
+  template <class U> void push_back(U&& u) {
+    emplace_back<std::decay_t<U>>(std::forward<U>(u));
+  }
+
+  template <class U, class... Args> U& emplace_back(Args&&... args);
+
+  template <class U, class... Args>
+  U& emplace_back(std::in_place_type_t<U>, Args&&... args) {
+    return emplace_back<U>(std::forward<Args>(args)...);
+  }
+
+  // O(log run_count())
+  [[nodiscard]] element_type operator[](std::size_t index);
+
+  template <class U> [[nodiscard]] U& get(std::size_t index);
+
+  template <class F> decltype(auto) visit(std::size_t index, F&& f);
+
+  // f(element) for every element, with one dispatch per run
+  template <class F> void for_each(F&& f);
+
+  // f(std::span<T>) for every run, in order
+  template <class F> void for_each_run(F&& f);
+
+  template <class T> [[nodiscard]] std::size_t count_type() const;
+
+  [[nodiscard]] std::size_t size() const noexcept { return size_; }
+
+  [[nodiscard]] std::size_t run_count() const noexcept { return runs.size(); }
+
+  class iterator;
+
+  [[nodiscard]] iterator begin() { return iterator(this, 0, 0); }
+
+  [[nodiscard]] iterator end() { return iterator(this, runs.size(), size_); }
+
+private:
+  static constexpr auto& dtable = detail::dtable<Types...>;
+  static constexpr auto& ctable = detail::ctable<Types...>;
+  static constexpr auto& mtable = detail::mtable<Types...>;
+
+  template <class F>
+  using visit_result_t = detail::visit_result_t<F, Types...>;
+
+  template <class F>
+  static constexpr auto& vtable = detail::vtable<F, Types...>;
+
+  template <class T, class F>
+  static void each_impl(F& f, std::byte* const p, std::size_t n) {
+    T* t = reinterpret_cast<T*>(p);
+    for (std::size_t i = 0; i < n; i++) {
+      f(t[i]);
+    }
+  }
+
+  template <class T, class F>
+  static void run_impl(F& f, std::byte* const p, std::size_t n) {
+    f(std::span<T>(reinterpret_cast<T*>(p), n));
+  }
+
+  template <class F>
+  static constexpr void (*etable[N])(F&, std::byte* const, std::size_t){
+      each_impl<Types, F>...};
+
+  template <class F>
+  static constexpr void (*rtable[N])(F&, std::byte* const, std::size_t){
+      run_impl<Types, F>...};
+
+  static constexpr auto& size_table = detail::size_table<Types...>;
+  static constexpr std::size_t max_align = std::max({alignof(Types)...});
+
+  static constexpr bool trivially_relocatable =
+      (is_trivially_relocatable_v<Types> && ...);
+  static constexpr bool trivially_copyable =
+      (std::is_trivially_copyable_v<Types> && ...);
+
+  struct run {
+    std::size_t start;  // index of the first element
+    std::size_t offset; // where it lives in `data`
+    tag_type tag;
+  };
+
+  std::vector<run> runs;
+  mutable std::size_t hint = 0; // run of the last lookup
+  std::size_t size_;
+  std::size_t capacity;
+  std::size_t used; // end of the last element in `data`
+  std::byte* data;
+
+  [[nodiscard]] std::size_t run_length(std::size_t r) const {
+    return (r + 1 < runs.size() ? runs[r + 1].start : size_) - runs[r].start;
+  }
+
+  [[nodiscard]] std::size_t find_run(std::size_t index) const;
+
+  [[nodiscard]] std::byte* locate(std::size_t r, std::size_t index) const {
+    return data + runs[r].offset +
+           (index - runs[r].start) * size_table[runs[r].tag];
+  }
+
+  void copy_from(const rle_vector& rhs);
+
+  void delete_data();
+
+  void reset();
+};
+
+// caches the current run, so stepping inside a run is a pointer bump
+template <class... Types> class rle_vector<Types...>::iterator {
+public:
+  using iterator_concept = std::forward_iterator_tag;
+  using iterator_category = std::input_iterator_tag;
+  using value_type = element_type;
+  using difference_type = std::ptrdiff_t;
+
+  iterator() = default;
+
+  iterator(rle_vector* vec, std::size_t r, std::size_t index)
+      : vec(vec), r(r), index(index) {
+    enter_run();
+  }
+
+  [[nodiscard]] value_type operator*() const { return {tag, p}; }
+
+  iterator& operator++() {
+    if (++index == run_end) {
+      ++r;
+      enter_run();
+    } else {
+      p += stride;
+    }
+    return *this;
+  }
+
+  iterator operator++(int) {
+    iterator tmp = *this;
+    ++*this;
+    return tmp;
+  }
+
+  [[nodiscard]] bool operator==(const iterator& rhs) const {
+    return index == rhs.index;
+  }
+
+private:
+  void enter_run() {
+    if (r < vec->runs.size()) {
+      tag = vec->runs[r].tag;
+      p = vec->data + vec->runs[r].offset;
+      stride = size_table[tag];
+      run_end = vec->runs[r].start + vec->run_length(r);
+    }
+  }
+
+  rle_vector* vec = nullptr;
+  std::size_t r = 0;
+  std::size_t index = 0;
+  std::size_t run_end = 0;
+  std::size_t stride = 0;
+  std::byte* p = nullptr;
+  tag_type tag = 0;
+};
+
+template <class... Types>
+rle_vector<Types...>::rle_vector()
+    : size_(0), capacity(0), used(0), data(nullptr) {}
+
+template <class... Types> rle_vector<Types...>::~rle_vector() {
+  delete_data();
+}
+
+template <class... Types>
+rle_vector<Types...>::rle_vector(const rle_vector& rhs) {
+  reset();
+  copy_from(rhs);
+}
+
+template <class... Types>
+rle_vector<Types...>::rle_vector(rle_vector&& rhs) noexcept
+    : runs(std::move(rhs.runs)), size_(rhs.size_), capacity(rhs.capacity),
+      used(rhs.used), data(rhs.data) {
+  rhs.reset();
+}
+
+template <class... Types>
+rle_vector<Types...>& rle_vector<Types...>::operator=(const rle_vector& rhs) {
+  if (this != &rhs) {
+    delete_data();
+    reset();
+    copy_from(rhs);
+  }
+  return *this;
+}
+
+template <class... Types>
+rle_vector<Types...>&
+rle_vector<Types...>::operator=(rle_vector&& rhs) noexcept {
+  if (this != &rhs) {
+    delete_data();
+    runs = std::move(rhs.runs);
+    size_ = rhs.size_;
+    capacity = rhs.capacity;
+    used = rhs.used;
+    data = rhs.data;
+    rhs.reset();
+  }
+  return *this;
+}
+
+template <class... Types>
+void rle_vector<Types...>::reserve_cap(std::size_t new_cap) {
+  if (new_cap > capacity) {
+    auto* new_data = static_cast<std::byte*>(
+        ::operator new(new_cap, std::align_val_t{max_align}));
+    // the payload base is max_align-aligned in both buffers, so runs keep
+    // their offsets
+    if constexpr (trivially_relocatable) {
+      if (used > 0) {
+        std::memcpy(new_data, data, used);
+      }
+    } else {
+      for (std::size_t r = 0; r < runs.size(); r++) {
+        std::size_t offset = runs[r].offset;
+        for (std::size_t i = 0; i < run_length(r); i++) {
+          mtable[runs[r].tag](new_data + offset, data + offset);
+          dtable[runs[r].tag](data + offset);
+          offset += size_table[runs[r].tag];
+        }
+      }
+    }
+    ::operator delete(data, std::align_val_t{max_align});
+    data = new_data;
+    capacity = new_cap;
+  }
+}
+
+template <class... Types>
+template <class U, class... Args>
+U& rle_vector<Types...>::emplace_back(Args&&... args) {
+  constexpr auto index =
+      static_cast<tag_type>(detail::find_type_index<0, U, Types...>());
+
+  // sizeof is a multiple of alignof, so only a new run needs padding
+  bool extends = !runs.empty() && runs.back().tag == index;
+  std::size_t offset = extends ? used : used + get_padding(used, alignof(U));
+  if (offset + sizeof(U) > capacity) {
+    reserve_cap(std::max(offset + sizeof(U), capacity * 2));
+  }
+
+  if (!extends) {
+    runs.push_back({size_, offset, index});
+  }
+  try {
+    U* obj = ::new (data + offset) U(std::forward<Args>(args)...);
+    used = offset + sizeof(U);
+    size_++;
+    return *obj;
+  } catch (...) {
+    if (!extends) {
+      runs.pop_back();
+    }
+    throw;
+  }
+}
+
+template <class... Types>
+[[nodiscard]] typename rle_vector<Types...>::element_type
+rle_vector<Types...>::operator[](std::size_t index) {
+  std::size_t r = find_run(index);
+  return {runs[r].tag, locate(r, index)};
+}
+
+template <class... Types>
+template <class T>
+[[nodiscard]] T& rle_vector<Types...>::get(std::size_t index) {
+  std::size_t r = find_run(index);
+  if (runs[r].tag != detail::find_type_index<0, T, Types...>()) {
+    throw std::bad_cast();
+  }
+  return *reinterpret_cast<T*>(locate(r, index));
+}
+
+template <class... Types>
+template <class F>
+decltype(auto) rle_vector<Types...>::visit(std::size_t index, F&& f) {
+  using Fn = std::remove_reference_t<F>;
+  std::size_t r = find_run(index);
+  return vtable<Fn>[runs[r].tag](f, locate(r, index));
+}
+
+template <class... Types>
+template <class F>
+void rle_vector<Types...>::for_each(F&& f) {
+  using Fn = std::remove_reference_t<F>;
+  for (std::size_t r = 0; r < runs.size(); r++) {
+    etable<Fn>[runs[r].tag](f, data + runs[r].offset, run_length(r));
+  }
+}
+
+template <class... Types>
+template <class F>
+void rle_vector<Types...>::for_each_run(F&& f) {
+  using Fn = std::remove_reference_t<F>;
+  for (std::size_t r = 0; r < runs.size(); r++) {
+    rtable<Fn>[runs[r].tag](f, data + runs[r].offset, run_length(r));
+  }
+}
+
+template <class... Types>
+template <class T>
+[[nodiscard]] std::size_t rle_vector<Types...>::count_type() const {
+  constexpr std::size_t k = detail::find_type_index<0, T, Types...>();
+  std::size_t count = 0;
+  for (std::size_t r = 0; r < runs.size(); r++) {
+    if (runs[r].tag == k) {
+      count += run_length(r);
+    }
+  }
+  return count;
+}
+
+// last run starting at or before `index`. lookups tend to stay in one run
+// (or move to the next), so those two are tried before the binary search
+template <class... Types>
+[[nodiscard]] std::size_t
+rle_vector<Types...>::find_run(std::size_t index) const {
+  auto holds = [&](std::size_t r) {
+    return r < runs.size() && runs[r].start <= index &&
+           index - runs[r].start < run_length(r);
+  };
+  if (holds(hint)) {
+    return hint;
+  }
+  if (holds(hint + 1)) {
+    return ++hint;
+  }
+  auto it = std::upper_bound(
+      runs.begin(), runs.end(), index,
+      [](std::size_t i, const run& rn) { return i < rn.start; });
+  hint = static_cast<std::size_t>(it - runs.begin()) - 1;
+  return hint;
+}
+
+template <class... Types>
+void rle_vector<Types...>::copy_from(const rle_vector& rhs) {
+  reserve_cap(rhs.used);
+  runs = rhs.runs;
+  if constexpr (trivially_copyable) {
+    if (rhs.used > 0) {
+      std::memcpy(data, rhs.data, rhs.used);
+    }
+    size_ = rhs.size_;
+  } else {
+    // size_ only counts constructed elements in case a copy throws; runs
+    // past it are dropped so exactly those get destroyed
+    try {
+      for (std::size_t r = 0; r < runs.size(); r++) {
+        std::size_t offset = runs[r].offset;
+        for (std::size_t i = 0; i < rhs.run_length(r); i++) {
+          ctable[runs[r].tag](data + offset, rhs.data + offset);
+          offset += size_table[runs[r].tag];
+          size_++;
+        }
+      }
+    } catch (...) {
+      while (!runs.empty() && runs.back().start >= size_) {
+        runs.pop_back();
+      }
+      delete_data();
+      reset();
+      throw;
+    }
+  }
+  used = rhs.used;
+}
+
+template <class... Types> void rle_vector<Types...>::delete_data() {
+  if constexpr (!(std::is_trivially_destructible_v<Types> && ...)) {
+    for (std::size_t r = 0; r < runs.size(); r++) {
+      std::byte* p = data + runs[r].offset;
+      for (std::size_t i = 0; i < run_length(r); i++) {
+        dtable[runs[r].tag](p);
+        p += size_table[runs[r].tag];
+      }
+    }
+  }
+  ::operator delete(data, std::align_val_t{max_align});
+}
+
+template <class... Types> void rle_vector<Types...>::reset() {
+  runs.clear();
+  hint = 0;
+  size_ = 0;
+  capacity = 0;
+  used = 0;
+  data = nullptr;
+}
+
+} // namespace vv3
@@ -0,0 +1,322 @@
+#pragma once
+
+#include "vv3.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <typeinfo>
+#include <utility>
+#include <vector>
+
+// vv3::vector that grows by appending fixed-size chunks instead of moving the
+// payload into a bigger buffer. elements never move once constructed, so
+// pointers from operator[]/get stay valid for the vector's lifetime and an
+// append never pays for relocating everything before it. each element keeps a
+// global offset; since ChunkBytes is a power of two the chunk is a shift away
+// and a lookup is two loads from the (small) chunk table
+namespace vv3 {
+
+template <std::size_t ChunkBytes, class... Types> class segmented_vector {
+  static constexpr std::size_t N = sizeof...(Types);
+
+  static_assert(std::has_single_bit(ChunkBytes),
+                "chunk size has to be a power of two");
+  static_assert(std::max({sizeof(Types)...}) <= ChunkBytes,
+                "every alternative has to fit in a chunk");
+
+public:
+  using tag_type = tag_for_t<N>;
+  using element_type = Element<tag_type>;
+
+  segmented_vector() = default;
+
+  ~segmented_vector();
+
+  segmented_vector(const segmented_vector& rhs);
+
+  segmented_vector(segmented_vector&& rhs) noexcept;
+
+  segmented_vector& operator=(const segmented_vector& rhs);
+
+  segmented_vector& operator=(segmented_vector&& rhs) noexcept;
+
+  void reserve_entries(std::size_t new_entries);
+
+  template <class U> void push_back(U&& u) {
+    emplace_back<std::decay_t<U>>(std::forward<U>(u));
+  }
+
+  template <class U, class... Args> U& emplace_back(Args&&... args);
+
+  template <class U, class... Args>
+  U& emplace_back(std::in_place_type_t<U>, Args&&... args) {
+    return emplace_back<U>(std::forward<Args>(args)...);
+  }
+
+  [[nodiscard]] element_type operator[](std::size_t index) const {
+    return {tags[index], locate(offsets[index])};
+  }
+
+  template <class U> [[nodiscard]] U& get(std::size_t index) const;
+
+  template <class F> decltype(auto) visit(std::size_t index, F&& f) const;
+
+  template <class F> void for_each(F&& f) const;
+
+  [[nodiscard]] std::size_t size() const noexcept { return tags.size(); }
+
+  [[nodiscard]] std::size_t chunk_count() const noexcept {
+    return chunks.size();
+  }
+
+  class iterator;
+
+  [[nodiscard]] iterator begin() const { return iterator(this, 0); }
+
+  [[nodiscard]] iterator end() const { return iterator(this, size()); }
+
+private:
+  static constexpr auto& dtable = detail::dtable<Types...>;
+  static constexpr auto& ctable = detail::ctable<Types...>;
+
+  template <class F>
+  using visit_result_t = detail::visit_result_t<F, Types...>;
+
+  template <class F>
+  static constexpr auto& vtable = detail::vtable<F, Types...>;
+
+  static constexpr auto& size_table = detail::size_table<Types...>;
+  static constexpr auto& align_table = detail::align_table<Types...>;
+  static constexpr std::size_t max_align = std::max({alignof(Types)...});
+  static constexpr std::size_t chunk_shift = std::countr_zero(ChunkBytes);
+
+  // chunks are allocated in whole max_align units, the way basic_vector
+  // allocates its block, so they come back aligned for every alternative
+  struct alignas(max_align) chunk_unit {
+    std::byte bytes[max_align];
+  };
+
+  using chunk_allocator = std::allocator<chunk_unit>;
+
+  static constexpr std::size_t chunk_units = ChunkBytes / max_align;
+
+  std::vector<std::byte*> chunks;
+  std::vector<tag_type> tags;
+  // chunk index * ChunkBytes + offset inside the chunk
+  std::vector<std::size_t> offsets;
+  std::size_t used = 0; // global offset one past the last element
+
+  [[nodiscard]] std::byte* locate(std::size_t offset) const {
+    return chunks[offset >> chunk_shift] + (offset & (ChunkBytes - 1));
+  }
+
+  void add_chunk();
+
+  void copy_from(const segmented_vector& rhs);
+
+  void release();
+};
+
+template <std::size_t ChunkBytes, class... Types>
+class segmented_vector<ChunkBytes, Types...>::iterator {
+public:
+  using iterator_concept = std::forward_iterator_tag;
+  using iterator_category = std::input_iterator_tag;
+  using value_type = element_type;
+  using difference_type = std::ptrdiff_t;
+
+  iterator() = default;
+
+  iterator(const segmented_vector* vec, std::size_t index)
+      : vec(vec), index(index) {}
+
+  [[nodiscard]] value_type operator*() const { return (*vec)[index]; }
+
+  iterator& operator++() {
+    ++index;
+    return *this;
+  }
+
+  iterator operator++(int) {
+    iterator tmp = *this;
+    ++index;
+    return tmp;
+  }
+
+  [[nodiscard]] bool operator==(const iterator& rhs) const {
+    return index == rhs.index;
+  }
+
+private:
+  const segmented_vector* vec = nullptr;
+  std::size_t index = 0;
+};
+
+template <std::size_t ChunkBytes, class... Types>
+segmented_vector<ChunkBytes, Types...>::~segmented_vector() {
+  release();
+}
+
+template <std::size_t ChunkBytes, class... Types>
+segmented_vector<ChunkBytes, Types...>::segmented_vector(
+    const segmented_vector& rhs) {
+  copy_from(rhs);
+}
+
+template <std::size_t ChunkBytes, class... Types>
+segmented_vector<ChunkBytes, Types...>::segmented_vector(
+    segmented_vector&& rhs) noexcept
+    : chunks(std::move(rhs.chunks)), tags(std::move(rhs.tags)),
+      offsets(std::move(rhs.offsets)), used(std::exchange(rhs.used, 0)) {
+  rhs.chunks.clear();
+  rhs.tags.clear();
+  rhs.offsets.clear();
+}
+
+template <std::size_t ChunkBytes, class... Types>
+segmented_vector<ChunkBytes, Types...>&
+segmented_vector<ChunkBytes, Types...>::operator=(const segmented_vector& rhs) {
+  if (this != &rhs) {
+    release();
+    copy_from(rhs);
+  }
+  return *this;
+}
+
+template <std::size_t ChunkBytes, class... Types>
+segmented_vector<ChunkBytes, Types...>&
+segmented_vector<ChunkBytes, Types...>::operator=(
+    segmented_vector&& rhs) noexcept {
+  if (this != &rhs) {
+    release();
+    chunks = std::move(rhs.chunks);
+    tags = std::move(rhs.tags);
+    offsets = std::move(rhs.offsets);
+    used = std::exchange(rhs.used, 0);
+    rhs.chunks.clear();
+    rhs.tags.clear();
+    rhs.offsets.clear();
+  }
+  return *this;
+}
+
+template <std::size_t ChunkBytes, class... Types>
+void segmented_vector<ChunkBytes, Types...>::reserve_entries(
+    std::size_t new_entries) {
+  tags.reserve(new_entries);
+  offsets.reserve(new_entries);
+}
+
+template <std::size_t ChunkBytes, class... Types>
+template <class U, class... Args>
+U& segmented_vector<ChunkBytes, Types...>::emplace_back(Args&&... args) {
+  constexpr std::size_t index = detail::find_type_index<0, U, Types...>();
+
+  std::size_t offset = used + get_padding(used, alignof(U));
+  // never straddle two chunks: start the next one instead
+  if (offset + sizeof(U) > chunks.size() * ChunkBytes) {
+    add_chunk();
+    offset = (chunks.size() - 1) * ChunkBytes;
+  }
+
+  // metadata first, so a throwing constructor only has to pop it again
+  tags.push_back(static_cast<tag_type>(index));
+  try {
+    offsets.push_back(offset);
+    U* obj = ::new (locate(offset)) U(std::forward<Args>(args)...);
+    used = offset + sizeof(U);
+    return *obj;
+  } catch (...) {
+    tags.pop_back();
+    offsets.resize(tags.size());
+    throw;
+  }
+}
+
+template <std::size_t ChunkBytes, class... Types>
+template <class T>
+[[nodiscard]] T&
+segmented_vector<ChunkBytes, Types...>::get(std::size_t index) const {
+  if (tags[index] != detail::find_type_index<0, T, Types...>()) {
+    throw std::bad_cast();
+  }
+  return *reinterpret_cast<T*>(locate(offsets[index]));
+}
+
+template <std::size_t ChunkBytes, class... Types>
+template <class F>
+decltype(auto)
+segmented_vector<ChunkBytes, Types...>::visit(std::size_t index,
+                                              F&& f) const {
+  using Fn = std::remove_reference_t<F>;
+  return vtable<Fn>[tags[index]](f, locate(offsets[index]));
+}
+
+template <std::size_t ChunkBytes, class... Types>
+template <class F>
+void segmented_vector<ChunkBytes, Types...>::for_each(F&& f) const {
+  for (std::size_t i = 0; i < size(); i++) {
+    visit(i, f);
+  }
+}
+
+template <std::size_t ChunkBytes, class... Types>
+void segmented_vector<ChunkBytes, Types...>::add_chunk() {
+  chunk_allocator alloc;
+  chunk_unit* chunk = alloc.allocate(chunk_units);
+  try {
+    chunks.push_back(reinterpret_cast<std::byte*>(chunk));
+  } catch (...) {
+    alloc.deallocate(chunk, chunk_units);
+    throw;
+  }
+}
+
+// chunks are laid out exactly as in rhs, so offsets carry over unchanged
+template <std::size_t ChunkBytes, class... Types>
+void segmented_vector<ChunkBytes, Types...>::copy_from(
+    const segmented_vector& rhs) {
+  try {
+    chunks.reserve(rhs.chunks.size());
+    tags.reserve(rhs.size());
+    offsets.reserve(rhs.size());
+    while (chunks.size() < rhs.chunks.size()) {
+      add_chunk();
+    }
+    // tags only count constructed elements in case a copy throws
+    for (std::size_t i = 0; i < rhs.size(); i++) {
+      ctable[rhs.tags[i]](locate(rhs.offsets[i]),
+                          rhs.locate(rhs.offsets[i]));
+      offsets.push_back(rhs.offsets[i]);
+      tags.push_back(rhs.tags[i]);
+    }
+  } catch (...) {
+    release();
+    throw;
+  }
+  used = rhs.used;
+}
+
+template <std::size_t ChunkBytes, class... Types>
+void segmented_vector<ChunkBytes, Types...>::release() {
+  if constexpr (!(std::is_trivially_destructible_v<Types> && ...)) {
+    for (std::size_t i = 0; i < size(); i++) {
+      dtable[tags[i]](locate(offsets[i]));
+    }
+  }
+  for (std::byte* chunk : chunks) {
+    chunk_allocator().deallocate(reinterpret_cast<chunk_unit*>(chunk),
+                                 chunk_units);
+  }
+  chunks.clear();
+  tags.clear();
+  offsets.clear();
+  used = 0;
+}
+
+} // namespace vv3
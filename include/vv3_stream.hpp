@@ -0,0 +1,368 @@
+#pragma once
+
+#include "vv3.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <new>
+#include <type_traits>
+#include <typeinfo>
+#include <utility>
+
+// append-then-scan sibling of vv3::vector that keeps no per-element offsets.
+// only tags and the aligned payload are stored; offsets are recomputed while
+// iterating, and random access starts from a checkpoint recorded every
+// `checkpoint_every` elements, so metadata is ~1 byte per element plus one
+// std::size_t per checkpoint
+namespace vv3 {
+
+template <class... Types> class stream_vector {
+  static constexpr std::size_t N = sizeof...(Types);
+
+public:
+  using tag_type = tag_for_t<N>;
+  using element_type = Element<tag_type>;
+  using iterator = sequential_iterator<Types...>;
+
+  static constexpr std::size_t checkpoint_every = 64;
+
+  stream_vector();
+
+  ~stream_vector();
+
+  stream_vector(const stream_vector& rhs);
+
+  stream_vector(stream_vector&& rhs) noexcept;
+
+  stream_vector& operator=(const stream_vector& rhs);
+
+  stream_vector& operator=(stream_vector&& rhs) noexcept;
+
+  void reserve_entries(std::size_t new_entries);
+
+  void reserve_cap(std::size_t new_cap);
+
+  template <class U> void push_back(const U& u);
+
+private:
+  // sfinae this to stop the universal rref push_back from competing in overload
+  // resolution if U is lvalue
+  template <class U, class = std::enable_if_t<!std::is_lvalue_reference_v<U>>>
+  using rval_ref = U&&;
+
+public:
+  template <class U> void push_back(rval_ref<U> u);
+
+  template <class U, class... Args> U& emplace_back(Args&&... args);
+
+  template <class U, class... Args>
+  U& emplace_back(std::in_place_type_t<U>, Args&&... args);
+
+  // O(checkpoint_every): walks forward from the nearest checkpoint
+  [[nodiscard]] element_type operator[](std::size_t index);
+
+  template <class U> [[nodiscard]] U& get(std::size_t index);
+
+  template <class F> decltype(auto) visit(std::size_t index, F&& f);
+
+  template <class F> void for_each(F&& f);
+
+  [[nodiscard]] iterator begin() { return iterator(tags, data, 0); }
+
+  [[nodiscard]] iterator end() { return iterator(tags + size_, data, 0); }
+
+  [[nodiscard]] std::size_t size() const noexcept { return size_; }
+
+private:
+  static constexpr auto& dtable = detail::dtable<Types...>;
+  static constexpr auto& ctable = detail::ctable<Types...>;
+  static constexpr auto& mtable = detail::mtable<Types...>;
+
+  template <class F>
+  using visit_result_t = detail::visit_result_t<F, Types...>;
+
+  template <class F>
+  static constexpr auto& vtable = detail::vtable<F, Types...>;
+
+  static constexpr auto& size_table = detail::size_table<Types...>;
+  static constexpr auto& align_table = detail::align_table<Types...>;
+  static constexpr std::size_t max_align = std::max({alignof(Types)...});
+
+  static constexpr bool trivially_relocatable =
+      (is_trivially_relocatable_v<Types> && ...);
+  static constexpr bool trivially_copyable =
+      (std::is_trivially_copyable_v<Types> && ...);
+
+  std::size_t size_;
+  std::size_t capacity;
+  std::size_t entries;
+  std::size_t used; // end of the last element in `data`
+
+  std::byte* data;
+  tag_type* tags;
+  std::size_t* checkpoints; // offset of every checkpoint_every'th element
+
+  [[nodiscard]] std::size_t get_offset(std::size_t index) const;
+
+  // reserves room for one more element of alternative `index`, records its tag
+  // (and checkpoint) and returns its offset
+  std::size_t place_obj(std::size_t index);
+
+  // calls f(tag, offset) for every element, in order
+  template <class F> void walk(F&& f) const;
+
+  void copy_from(const stream_vector& rhs);
+
+  void delete_data();
+
+  void reset();
+};
+
+template <class... Types>
+stream_vector<Types...>::stream_vector()
+    : size_(0), capacity(0), entries(0), used(0), data(nullptr),
+      tags(nullptr), checkpoints(nullptr) {}
+
+template <class... Types> stream_vector<Types...>::~stream_vector() {
+  delete_data();
+}
+
+template <class... Types>
+stream_vector<Types...>::stream_vector(const stream_vector& rhs) {
+  reset();
+  copy_from(rhs);
+}
+
+template <class... Types>
+stream_vector<Types...>::stream_vector(stream_vector&& rhs) noexcept
+    : size_(rhs.size_), capacity(rhs.capacity), entries(rhs.entries),
+      used(rhs.used), data(rhs.data), tags(rhs.tags),
+      checkpoints(rhs.checkpoints) {
+  rhs.reset();
+}
+
+template <class... Types>
+stream_vector<Types...>&
+stream_vector<Types...>::operator=(const stream_vector& rhs) {
+  if (this != &rhs) {
+    delete_data();
+    reset();
+    copy_from(rhs);
+  }
+  return *this;
+}
+
+template <class... Types>
+stream_vector<Types...>&
+stream_vector<Types...>::operator=(stream_vector&& rhs) noexcept {
+  if (this != &rhs) {
+    delete_data();
+    size_ = rhs.size_;
+    capacity = rhs.capacity;
+    entries = rhs.entries;
+    used = rhs.used;
+    data = rhs.data;
+    tags = rhs.tags;
+    checkpoints = rhs.checkpoints;
+    rhs.reset();
+  }
+  return *this;
+}
+
+template <class... Types>
+void stream_vector<Types...>::reserve_entries(std::size_t new_entries) {
+  if (new_entries > entries) {
+    std::size_t new_checkpoints =
+        (new_entries + checkpoint_every - 1) / checkpoint_every;
+    tag_type* new_tags = new tag_type[new_entries];
+    std::size_t* new_cps = new std::size_t[new_checkpoints];
+
+    if (size_ > 0) {
+      std::memcpy(new_tags, tags, size_ * sizeof(tag_type));
+      std::memcpy(new_cps, checkpoints,
+                  ((size_ + checkpoint_every - 1) / checkpoint_every) *
+                      sizeof(std::size_t));
+    }
+
+    delete[] tags;
+    delete[] checkpoints;
+
+    tags = new_tags;
+    checkpoints = new_cps;
+    entries = new_entries;
+  }
+}
+
+template <class... Types>
+void stream_vector<Types...>::reserve_cap(std::size_t new_cap) {
+  if (new_cap > capacity) {
+    auto* new_data = static_cast<std::byte*>(
+        ::operator new(new_cap, std::align_val_t{max_align}));
+    // the payload base is max_align-aligned in both buffers, so every element
+    // keeps its offset
+    if constexpr (trivially_relocatable) {
+      if (used > 0) {
+        std::memcpy(new_data, data, used);
+      }
+    } else {
+      walk([&](tag_type t, std::size_t offset) {
+        mtable[t](new_data + offset, data + offset);
+        dtable[t](data + offset);
+      });
+    }
+    ::operator delete(data, std::align_val_t{max_align});
+    data = new_data;
+    capacity = new_cap;
+  }
+}
+
+template <class... Types>
+template <class U>
+void stream_vector<Types...>::push_back(const U& u) {
+  emplace_back<U>(u);
+}
+
+template <class... Types>
+template <class U>
+void stream_vector<Types...>::push_back(rval_ref<U> u) {
+  emplace_back<std::decay_t<U>>(std::move(u));
+}
+
+template <class... Types>
+template <class U, class... Args>
+U& stream_vector<Types...>::emplace_back(Args&&... args) {
+  std::size_t offset = place_obj(detail::find_type_index<0, U, Types...>());
+  U* obj = ::new (data + offset) U(std::forward<Args>(args)...);
+  used = offset + sizeof(U);
+  size_++;
+  return *obj;
+}
+
+template <class... Types>
+template <class U, class... Args>
+U& stream_vector<Types...>::emplace_back(std::in_place_type_t<U>,
+                                         Args&&... args) {
+  return emplace_back<U>(std::forward<Args>(args)...);
+}
+
+template <class... Types>
+[[nodiscard]] typename stream_vector<Types...>::element_type
+stream_vector<Types...>::operator[](std::size_t index) {
+  return {tags[index], data + get_offset(index)};
+}
+
+template <class... Types>
+template <class T>
+[[nodiscard]] T& stream_vector<Types...>::get(std::size_t index) {
+  if (tags[index] != detail::find_type_index<0, T, Types...>()) {
+    throw std::bad_cast();
+  }
+  return *reinterpret_cast<T*>(data + get_offset(index));
+}
+
+template <class... Types>
+template <class F>
+decltype(auto) stream_vector<Types...>::visit(std::size_t index, F&& f) {
+  using Fn = std::remove_reference_t<F>;
+  return vtable<Fn>[tags[index]](f, data + get_offset(index));
+}
+
+template <class... Types>
+template <class F>
+void stream_vector<Types...>::for_each(F&& f) {
+  using Fn = std::remove_reference_t<F>;
+  walk([&](tag_type t, std::size_t offset) { vtable<Fn>[t](f, data + offset); });
+}
+
+template <class... Types>
+[[nodiscard]] std::size_t
+stream_vector<Types...>::get_offset(std::size_t index) const {
+  std::size_t i = index - index % checkpoint_every;
+  std::size_t offset = checkpoints[i / checkpoint_every];
+  for (; i < index; i++) {
+    offset += size_table[tags[i]];
+    offset += get_padding(offset, align_table[tags[i + 1]]);
+  }
+  return offset;
+}
+
+template <class... Types>
+std::size_t stream_vector<Types...>::place_obj(std::size_t index) {
+  if (size_ == entries) {
+    reserve_entries(2 * entries + 1);
+  }
+
+  std::size_t offset = used + get_padding(used, align_table[index]);
+  std::size_t new_cap = offset + size_table[index];
+  if (new_cap > capacity) {
+    reserve_cap(std::max(new_cap, capacity * 2));
+  }
+
+  tags[size_] = static_cast<tag_type>(index);
+  if (size_ % checkpoint_every == 0) {
+    checkpoints[size_ / checkpoint_every] = offset;
+  }
+  return offset;
+}
+
+template <class... Types>
+template <class F>
+void stream_vector<Types...>::walk(F&& f) const {
+  std::size_t offset = 0;
+  for (std::size_t i = 0; i < size_; i++) {
+    offset += get_padding(offset, align_table[tags[i]]);
+    f(tags[i], offset);
+    offset += size_table[tags[i]];
+  }
+}
+
+template <class... Types>
+void stream_vector<Types...>::copy_from(const stream_vector& rhs) {
+  reserve_entries(rhs.size_);
+  reserve_cap(rhs.used);
+  if (rhs.size_ == 0) {
+    return;
+  }
+
+  std::memcpy(tags, rhs.tags, rhs.size_ * sizeof(tag_type));
+  std::memcpy(checkpoints, rhs.checkpoints,
+              ((rhs.size_ + checkpoint_every - 1) / checkpoint_every) *
+                  sizeof(std::size_t));
+
+  if constexpr (trivially_copyable) {
+    std::memcpy(data, rhs.data, rhs.used);
+    size_ = rhs.size_;
+  } else {
+    // size_ only counts constructed elements in case a copy throws
+    std::size_t offset = 0;
+    for (; size_ < rhs.size_; size_++) {
+      tag_type t = tags[size_];
+      offset += get_padding(offset, align_table[t]);
+      ctable[t](data + offset, rhs.data + offset);
+      offset += size_table[t];
+    }
+  }
+  used = rhs.used;
+}
+
+template <class... Types> void stream_vector<Types...>::delete_data() {
+  if constexpr (!(std::is_trivially_destructible_v<Types> && ...)) {
+    walk([&](tag_type t, std::size_t offset) { dtable[t](data + offset); });
+  }
+  ::operator delete(data, std::align_val_t{max_align});
+  delete[] tags;
+  delete[] checkpoints;
+}
+
+template <class... Types> void stream_vector<Types...>::reset() {
+  size_ = 0;
+  capacity = 0;
+  entries = 0;
+  used = 0;
+  data = nullptr;
+  tags = nullptr;
+  checkpoints = nullptr;
+}
+
+} // namespace vv3
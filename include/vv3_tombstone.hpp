@@ -0,0 +1,233 @@
+#pragma once
+
+#include "vv3.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if defined(__BMI2__)
+#include <immintrin.h>
+#endif
+
+// vv3::vector with lazy erase: erasing only sets a bit in a tombstone mask,
+// and the dead elements are dropped in one erase_mask() pass once they make
+// up more than `max_dead_ratio` of what is stored. erase-heavy workloads
+// (sliding windows, queues) then pay for one O(n) compaction every so often
+// instead of an O(n) shift per erase. erased elements stay alive until that
+// compaction. while tombstones are pending, positional access has to skip
+// them: a per-word count of live elements (rebuilt on the first lookup after
+// an erase) is binary searched for the word, then the bit is selected inside
+// it
+namespace vv3 {
+
+template <class... Types> class tombstone_vector {
+public:
+  using tag_type = typename vector<Types...>::tag_type;
+  using element_type = typename vector<Types...>::element_type;
+
+  explicit tombstone_vector(double max_dead_ratio = 0.25)
+      : max_dead_ratio(max_dead_ratio) {}
+
+  void reserve_entries(std::size_t new_entries) {
+    vec.reserve_entries(new_entries);
+    dead.reserve((new_entries + 63) / 64);
+  }
+
+  void reserve_cap(std::size_t new_cap) { vec.reserve_cap(new_cap); }
+
+  template <class U> void push_back(U&& u) {
+    emplace_back<std::decay_t<U>>(std::forward<U>(u));
+  }
+
+  template <class U, class... Args> U& emplace_back(Args&&... args);
+
+  template <class U, class... Args>
+  U& emplace_back(std::in_place_type_t<U>, Args&&... args) {
+    return emplace_back<U>(std::forward<Args>(args)...);
+  }
+
+  void erase(std::size_t index) { erase(index, index + 1); }
+
+  void erase(std::size_t first, std::size_t last);
+
+  void pop_back() { erase(size() - 1); }
+
+  void clear() noexcept;
+
+  // drops every tombstone now, making positional access O(1) again
+  void compact();
+
+  [[nodiscard]] element_type operator[](std::size_t index) {
+    return vec[physical(index)];
+  }
+
+  template <class U> [[nodiscard]] U& get(std::size_t index) {
+    return vec.template get<U>(physical(index));
+  }
+
+  template <class F> decltype(auto) visit(std::size_t index, F&& f) {
+    return vec.visit(physical(index), std::forward<F>(f));
+  }
+
+  // live elements only, in order
+  template <class F> void for_each(F&& f);
+
+  [[nodiscard]] std::size_t size() const noexcept {
+    return vec.size() - dead_count;
+  }
+
+  // erased elements still waiting for a compaction
+  [[nodiscard]] std::size_t tombstones() const noexcept { return dead_count; }
+
+private:
+  vector<Types...> vec;
+  // bit i % 64 of word i / 64 is set iff stored element i is erased, as in
+  // vector::type_mask()
+  std::vector<std::uint64_t> dead;
+  std::size_t dead_count = 0;
+  double max_dead_ratio;
+
+  // live_before[w] is the number of live elements in words [0, w). only
+  // valid while `counted` is set, which any change to `dead` clears
+  mutable std::vector<std::size_t> live_before;
+  mutable bool counted = false;
+
+  // where the index-th live element is stored
+  [[nodiscard]] std::size_t physical(std::size_t index) const;
+
+  void count_live() const;
+
+  // position of the n-th (from 0) set bit of `word`, which has more than n
+  [[nodiscard]] static std::size_t select_bit(std::uint64_t word,
+                                              std::size_t n);
+};
+
+template <class... Types>
+template <class U, class... Args>
+U& tombstone_vector<Types...>::emplace_back(Args&&... args) {
+  U& obj = vec.template emplace_back<U>(std::forward<Args>(args)...);
+  if (dead.size() * 64 < vec.size()) {
+    try {
+      dead.push_back(0);
+    } catch (...) {
+      vec.pop_back();
+      throw;
+    }
+    counted = false;
+  }
+  return obj;
+}
+
+template <class... Types>
+void tombstone_vector<Types...>::erase(std::size_t first, std::size_t last) {
+  if (first == last) {
+    return;
+  }
+  // dead elements in between are skipped, not counted
+  std::size_t p = physical(first);
+  for (std::size_t left = last - first; left > 0; p++) {
+    std::uint64_t bit = std::uint64_t{1} << (p % 64);
+    if (!(dead[p / 64] & bit)) {
+      dead[p / 64] |= bit;
+      left--;
+    }
+  }
+  dead_count += last - first;
+  counted = false;
+
+  if (static_cast<double>(dead_count) >
+      max_dead_ratio * static_cast<double>(vec.size())) {
+    compact();
+  }
+}
+
+template <class... Types> void tombstone_vector<Types...>::clear() noexcept {
+  vec.clear();
+  dead.clear();
+  dead_count = 0;
+  counted = false;
+}
+
+template <class... Types> void tombstone_vector<Types...>::compact() {
+  if (dead_count == 0) {
+    return;
+  }
+  vec.erase_mask(dead);
+  dead.assign((vec.size() + 63) / 64, 0);
+  dead_count = 0;
+  counted = false;
+}
+
+template <class... Types>
+template <class F>
+void tombstone_vector<Types...>::for_each(F&& f) {
+  std::size_t n = vec.size();
+  for (std::size_t w = 0; w < dead.size(); w++) {
+    for (std::uint64_t live = ~dead[w]; live != 0; live &= live - 1) {
+      std::size_t p = w * 64 + static_cast<std::size_t>(std::countr_zero(live));
+      if (p >= n) {
+        return;
+      }
+      vec.visit(p, f);
+    }
+  }
+}
+
+template <class... Types>
+[[nodiscard]] std::size_t
+tombstone_vector<Types...>::physical(std::size_t index) const {
+  if (dead_count == 0) {
+    return index;
+  }
+  if (!counted) {
+    count_live();
+  }
+  // last word with at most `index` live elements before it
+  auto it = std::upper_bound(live_before.begin(), live_before.end(), index);
+  auto w = static_cast<std::size_t>(it - live_before.begin()) - 1;
+  index -= live_before[w];
+
+  return w * 64 + select_bit(~dead[w], index);
+}
+
+template <class... Types>
+[[nodiscard]] std::size_t
+tombstone_vector<Types...>::select_bit(std::uint64_t word, std::size_t n) {
+#if defined(__BMI2__)
+  return static_cast<std::size_t>(
+      std::countr_zero(_pdep_u64(std::uint64_t{1} << n, word)));
+#else
+  // narrow down by halves, without branches: which half the bit is in is as
+  // good as random
+  std::size_t pos = 0;
+  for (std::size_t width = 32; width > 0; width /= 2) {
+    auto low = static_cast<std::size_t>(
+        std::popcount(word & ((std::uint64_t{1} << width) - 1)));
+    std::size_t upper = n >= low;
+    n -= upper * low;
+    word >>= upper * width;
+    pos += upper * width;
+  }
+  return pos;
+#endif
+}
+
+// bits past the last element are clear, so they count as live; the element
+// asked for always comes before them
+template <class... Types>
+void tombstone_vector<Types...>::count_live() const {
+  live_before.resize(dead.size());
+  std::size_t live = 0;
+  for (std::size_t w = 0; w < dead.size(); w++) {
+    live_before[w] = live;
+    live += static_cast<std::size_t>(std::popcount(~dead[w]));
+  }
+  counted = true;
+}
+
+} // namespace vv3
@@ -1,14 +1,22 @@
 #pragma once
 
+#include <algorithm>
+#include <bit>
 #include <cassert>
 #include <concepts>
 #include <cstddef>
 #include <cstdint>
 #include <cstring>
 #include <iostream>
+#include <new>
 #include <type_traits>
 #include <typeinfo>
 #include <utility>
+#include <vector>
+
+#if defined(__BMI2__)
+#include <immintrin.h>
+#endif
 
 // replace type storage w/ bitmap that stores types using min # of types
 // so if we had variant<int, short, long> -> 00, 01, 10
@@ -20,42 +28,458 @@ namespace detail {
 
 template <std::size_t I, class Q, class T, class... Rest>
 constexpr std::size_t find_type_in_pack() {
-  if (std::same_as<std::decay_t<Q>, std::decay_t<T>>) {
+  if constexpr (std::same_as<std::decay_t<Q>, std::decay_t<T>>) {
     return I;
   } else {
-    static_assert(sizeof...(Rest) > 0);
+    static_assert(sizeof...(Rest) > 0, "type is not an alternative");
     return find_type_in_pack<I + 1, Q, Rest...>();
   }
 }
 
-template <class T> constexpr std::size_t get_padding(std::uintptr_t addr) {
-  std::size_t align = alignof(T);
+// ceil(log2(n)), the number of bits needed to tell n alternatives apart
+constexpr std::size_t tag_bits(std::size_t n) {
+  return n <= 1 ? 0 : std::bit_width(n - 1);
+}
+
+// offsets are relative to the start of the payload buffer, which is always
+// allocated with the strictest alignment of the alternatives, so padding can be
+// computed from the offset alone and survives relocation
+constexpr std::size_t get_padding(std::uintptr_t addr, std::size_t align) {
   std::size_t aligned_addr = (addr + (align - 1)) & ~(align - 1);
   return aligned_addr - addr;
 }
 
+template <class T> constexpr std::size_t get_padding(std::uintptr_t addr) {
+  return get_padding(addr, alignof(T));
+}
+
 // assumes there is enough space allocated at `addr`
-template <class T>
-constexpr std::size_t copy_to(std::uintptr_t* addr, const void* const p) {
-  std::uintptr_t u_addr = reinterpret_cast<std::uintptr_t>(addr);
-  std::size_t padding = get_padding<T>(addr);
-  const auto& data = *reinterpret_cast<const T* const>(p);
-  ::new (addr + padding) T(data);
-  return padding;
+template <class T> void copy_to(std::byte* const addr, const void* const p) {
+  ::new (addr) T(*static_cast<const T*>(p));
 }
 
 // assumes there is enough space allocated at `addr`
-template <class T>
-constexpr std::size_t move_to(std::uintptr_t* addr, void* const p) {
-  std::uintptr_t u_addr = reinterpret_cast<std::uintptr_t>(addr);
-  std::size_t padding = get_padding<T>(addr);
-  const auto& data = *reinterpret_cast<const T* const>(p);
-  ::new (addr + padding) T(std::move(data));
-  return padding;
+template <class T> void move_to(std::byte* const addr, void* const p) {
+  ::new (addr) T(std::move(*static_cast<T*>(p)));
+}
+
+template <class T> void destroy_at(std::byte* const addr) {
+  reinterpret_cast<T*>(addr)->~T();
+}
+
+// reads `Size` bits starting `bit` bits past `addr`. tags are at most 8 bits
+// wide, so one tag never spans more than two bytes; the tag buffer keeps a
+// trailing byte so the second load is always in bounds
+template <std::size_t Size>
+constexpr std::size_t read_bits(const std::byte* const addr, std::size_t bit) {
+  static_assert(Size <= 8);
+  if constexpr (Size == 0) {
+    return 0;
+  } else {
+    const std::byte* p = addr + bit / 8;
+    std::size_t word = std::to_integer<std::size_t>(p[0]) |
+                       (std::to_integer<std::size_t>(p[1]) << 8);
+    return (word >> (bit % 8)) & ((std::size_t{1} << Size) - 1);
+  }
 }
 
 template <std::size_t Size>
-constexpr std::size_t read_bits(const std::byte* const addr) {}
+constexpr void write_bits(std::byte* const addr, std::size_t bit,
+                          std::size_t value) {
+  static_assert(Size <= 8);
+  if constexpr (Size > 0) {
+    std::byte* p = addr + bit / 8;
+    std::size_t shift = bit % 8;
+    std::size_t mask = ((std::size_t{1} << Size) - 1) << shift;
+    std::size_t word = std::to_integer<std::size_t>(p[0]) |
+                       (std::to_integer<std::size_t>(p[1]) << 8);
+    word = (word & ~mask) | ((value << shift) & mask);
+    p[0] = static_cast<std::byte>(word & 0xff);
+    p[1] = static_cast<std::byte>(word >> 8);
+  }
+}
+
+// SWAR scans over packed tags, used by count_type/find_type/type_mask. when
+// `Bits` divides 8 a 64-bit word holds 64 / Bits whole tags, so one xor against
+// the wanted tag replicated into every field plus a zero-field test compares
+// all of them at once. other widths straddle words and fall back to read_bits
+template <std::size_t Bits>
+inline constexpr bool swar_tags =
+    Bits > 0 && 8 % Bits == 0 && std::endian::native == std::endian::little;
+
+template <std::size_t Bits> constexpr std::uint64_t broadcast(std::uint64_t v) {
+  std::uint64_t r = 0;
+  for (std::size_t i = 0; i < 64; i += Bits) {
+    r |= v << i;
+  }
+  return r;
+}
+
+// top bit of every field that is zero in `x`, nothing else
+template <std::size_t Bits> constexpr std::uint64_t zero_fields(std::uint64_t x) {
+  constexpr std::uint64_t low = broadcast<Bits>((std::uint64_t{1} << (Bits - 1)) - 1);
+  return ~(((x & low) + low) | x | low);
+}
+
+// top bit of every field in word `w` equal to `k`
+template <std::size_t Bits>
+std::uint64_t match_word(const std::byte* const tags, std::size_t w,
+                         std::size_t k) {
+  constexpr std::uint64_t ones = broadcast<Bits>(1);
+  std::uint64_t word;
+  std::memcpy(&word, tags + w * 8, sizeof(word));
+  return zero_fields<Bits>(word ^ (k * ones));
+}
+
+template <std::size_t Bits>
+std::size_t count_tags(const std::byte* const tags, std::size_t n,
+                       std::size_t k) {
+  std::size_t count = 0;
+  std::size_t i = 0;
+  if constexpr (swar_tags<Bits>) {
+    constexpr std::size_t per_word = 64 / Bits;
+    for (; i + per_word <= n; i += per_word) {
+      count += std::popcount(match_word<Bits>(tags, i / per_word, k));
+    }
+  }
+  for (; i < n; i++) {
+    count += read_bits<Bits>(tags, i * Bits) == k;
+  }
+  return count;
+}
+
+template <std::size_t Bits>
+std::size_t find_tag(const std::byte* const tags, std::size_t first,
+                     std::size_t n, std::size_t k) {
+  std::size_t i = first;
+  if constexpr (swar_tags<Bits>) {
+    constexpr std::size_t per_word = 64 / Bits;
+    std::size_t w = first / per_word;
+    // the first word may start before `first`, drop the fields ahead of it
+    std::uint64_t skip = ~std::uint64_t{0} << (first % per_word * Bits);
+    for (; (w + 1) * per_word <= n; w++, skip = ~std::uint64_t{0}) {
+      if (std::uint64_t z = match_word<Bits>(tags, w, k) & skip) {
+        return w * per_word + std::countr_zero(z) / Bits;
+      }
+    }
+    i = std::max(first, w * per_word);
+  }
+  for (; i < n; i++) {
+    if (read_bits<Bits>(tags, i * Bits) == k) {
+      return i;
+    }
+  }
+  return n;
+}
+
+// sets bit i % 64 of out[i / 64] for every match; `out` starts zeroed
+template <std::size_t Bits>
+void mask_tags(const std::byte* const tags, std::size_t n, std::size_t k,
+               std::uint64_t* out) {
+  std::size_t i = 0;
+  if constexpr (swar_tags<Bits>) {
+    constexpr std::size_t per_word = 64 / Bits;
+    for (; i + per_word <= n; i += per_word) {
+      std::uint64_t z = match_word<Bits>(tags, i / per_word, k);
+      // per_word divides 64, so a word's fields land in a single output word
+#if defined(__BMI2__)
+      constexpr std::uint64_t tops = broadcast<Bits>(std::uint64_t{1}
+                                                     << (Bits - 1));
+      out[i / 64] |= _pext_u64(z, tops) << (i % 64);
+#else
+      for (; z; z &= z - 1) {
+        std::size_t at = i + std::countr_zero(z) / Bits;
+        out[at / 64] |= std::uint64_t{1} << (at % 64);
+      }
+#endif
+    }
+  }
+  for (; i < n; i++) {
+    out[i / 64] |= std::uint64_t{read_bits<Bits>(tags, i * Bits) == k}
+                   << (i % 64);
+  }
+}
 
 } // namespace detail
+
+struct Element {
+  std::size_t type_index;
+  std::byte* data;
+};
+
+template <class... Types> class vector {
+public:
+  vector();
+
+  ~vector();
+
+  vector(const vector& rhs);
+
+  vector(vector&& rhs) noexcept;
+
+  vector& operator=(const vector& rhs);
+
+  vector& operator=(vector&& rhs) noexcept;
+
+  void reserve_entries(std::size_t new_entries);
+
+  void reserve_cap(std::size_t new_cap);
+
+  template <class U> void push_back(const U& u);
+
+private:
+  // sfinae this to stop the universal rref push_back from competing in overload
+  // resolution if U is lvalue
+  template <class U, class = std::enable_if_t<!std::is_lvalue_reference_v<U>>>
+  using rval_ref = U&&;
+
+public:
+  template <class U> void push_back(rval_ref<U> u);
+
+  [[nodiscard]] Element operator[](std::size_t index);
+
+  template <class U> [[nodiscard]] U& get(std::size_t index);
+
+  [[nodiscard]] std::size_t size() const noexcept { return size_; }
+
+  // alternative held by element `index`
+  [[nodiscard]] std::size_t type_index(std::size_t index) const {
+    return detail::read_bits<bits>(tags, index * bits);
+  }
+
+  // number of elements holding `T`, compared a word of tags at a time
+  template <class T> [[nodiscard]] std::size_t count_type() const {
+    return detail::count_tags<bits>(tags, size_,
+                                    detail::find_type_in_pack<0, T, Types...>());
+  }
+
+  // first element at or after `from` holding `T`, or size() if there is none
+  template <class T>
+  [[nodiscard]] std::size_t find_type(std::size_t from = 0) const {
+    return from < size_ ? detail::find_tag<bits>(
+                              tags, from, size_,
+                              detail::find_type_in_pack<0, T, Types...>())
+                        : size_;
+  }
+
+  // bit i % 64 of word i / 64 is set iff element i holds `T`
+  template <class T> [[nodiscard]] std::vector<std::uint64_t> type_mask() const {
+    std::vector<std::uint64_t> mask((size_ + 63) / 64);
+    detail::mask_tags<bits>(tags, size_,
+                            detail::find_type_in_pack<0, T, Types...>(),
+                            mask.data());
+    return mask;
+  }
+
+  // bytes used by the packed tag array for `n` elements
+  static constexpr std::size_t tag_bytes(std::size_t n) {
+    return (n * bits + 7) / 8 + 1;
+  }
+
+private:
+  static constexpr std::size_t N = sizeof...(Types);
+  static_assert(N > 0 && N <= 256, "tags are read as at most 8 bits");
+
+  static constexpr std::size_t bits = detail::tag_bits(N);
+  static constexpr std::size_t max_align = std::max({alignof(Types)...});
+
+  using dtor_fptr_t = void (*)(std::byte* const);
+  using copy_fptr_t = void (*)(std::byte* const, const void* const);
+  using move_fptr_t = void (*)(std::byte* const, void* const);
+
+  static constexpr dtor_fptr_t dtable[N]{detail::destroy_at<Types>...};
+  static constexpr copy_fptr_t ctable[N]{detail::copy_to<Types>...};
+  static constexpr move_fptr_t mtable[N]{detail::move_to<Types>...};
+  static constexpr std::size_t size_table[N]{sizeof(Types)...};
+  static constexpr std::size_t align_table[N]{alignof(Types)...};
+
+  std::size_t size_;
+  std::size_t capacity;
+  std::size_t entries;
+  std::size_t used; // end of the last element in `data`
+
+  std::byte* data;
+  std::size_t* offsets;
+  std::byte* tags;
+
+  // reserves room for one more element of alternative `index` and returns its
+  // offset; the caller constructs the object and bumps size_
+  std::size_t prepare_slot(std::size_t index);
+
+  void copy_from(const vector& rhs);
+
+  void delete_data();
+
+  void reset();
+};
+
+template <class... Types>
+vector<Types...>::vector()
+    : size_(0), capacity(0), entries(0), used(0), data(nullptr),
+      offsets(nullptr), tags(nullptr) {}
+
+template <class... Types> vector<Types...>::~vector() { delete_data(); }
+
+template <class... Types> vector<Types...>::vector(const vector& rhs) {
+  reset();
+  copy_from(rhs);
+}
+
+template <class... Types>
+vector<Types...>::vector(vector&& rhs) noexcept
+    : size_(rhs.size_), capacity(rhs.capacity), entries(rhs.entries),
+      used(rhs.used), data(rhs.data), offsets(rhs.offsets), tags(rhs.tags) {
+  rhs.reset();
+}
+
+template <class... Types>
+vector<Types...>& vector<Types...>::operator=(const vector& rhs) {
+  if (this != &rhs) {
+    delete_data();
+    reset();
+    copy_from(rhs);
+  }
+  return *this;
+}
+
+template <class... Types>
+vector<Types...>& vector<Types...>::operator=(vector&& rhs) noexcept {
+  if (this != &rhs) {
+    delete_data();
+    size_ = rhs.size_;
+    capacity = rhs.capacity;
+    entries = rhs.entries;
+    used = rhs.used;
+    data = rhs.data;
+    offsets = rhs.offsets;
+    tags = rhs.tags;
+    rhs.reset();
+  }
+  return *this;
+}
+
+template <class... Types>
+template <class U>
+void vector<Types...>::push_back(const U& u) {
+  constexpr std::size_t index = detail::find_type_in_pack<0, U, Types...>();
+  std::size_t offset = prepare_slot(index);
+  ctable[index](data + offset, &u);
+  size_++;
+}
+
+template <class... Types>
+template <class U>
+void vector<Types...>::push_back(rval_ref<U> u) {
+  constexpr std::size_t index = detail::find_type_in_pack<0, U, Types...>();
+  std::size_t offset = prepare_slot(index);
+  mtable[index](data + offset, &u);
+  size_++;
+}
+
+template <class... Types>
+[[nodiscard]] Element vector<Types...>::operator[](std::size_t index) {
+  return {
+      type_index(index),
+      data + offsets[index],
+  };
+}
+
+template <class... Types>
+template <class T>
+[[nodiscard]] T& vector<Types...>::get(std::size_t index) {
+  if (type_index(index) != detail::find_type_in_pack<0, T, Types...>()) {
+    throw std::bad_cast();
+  }
+  return *reinterpret_cast<T*>(data + offsets[index]);
+}
+
+template <class... Types>
+void vector<Types...>::reserve_entries(std::size_t new_entries) {
+  if (new_entries > entries) {
+    std::size_t* new_offsets = new std::size_t[new_entries];
+    std::byte* new_tags = new std::byte[tag_bytes(new_entries)]();
+
+    if (size_ > 0) {
+      std::memcpy(new_offsets, offsets, size_ * sizeof(std::size_t));
+      std::memcpy(new_tags, tags, tag_bytes(size_));
+    }
+
+    delete[] offsets;
+    delete[] tags;
+
+    offsets = new_offsets;
+    tags = new_tags;
+    entries = new_entries;
+  }
+}
+
+template <class... Types>
+void vector<Types...>::reserve_cap(std::size_t new_cap) {
+  if (new_cap > capacity) {
+    auto* new_data = static_cast<std::byte*>(
+        ::operator new(new_cap, std::align_val_t{max_align}));
+    // offsets are relative to an equally aligned base, so every element keeps
+    // its offset and only has to be moved across
+    for (std::size_t i = 0; i < size_; i++) {
+      std::size_t t = type_index(i);
+      mtable[t](new_data + offsets[i], data + offsets[i]);
+      dtable[t](data + offsets[i]);
+    }
+    ::operator delete(data, std::align_val_t{max_align});
+    data = new_data;
+    capacity = new_cap;
+  }
+}
+
+template <class... Types>
+std::size_t vector<Types...>::prepare_slot(std::size_t index) {
+  if (size_ == entries) {
+    reserve_entries(2 * entries + 1);
+  }
+
+  std::size_t offset = used + detail::get_padding(used, align_table[index]);
+  std::size_t new_cap = offset + size_table[index];
+  if (new_cap > capacity) {
+    reserve_cap(std::max(new_cap, capacity * 2));
+  }
+
+  offsets[size_] = offset;
+  detail::write_bits<bits>(tags, size_ * bits, index);
+  used = new_cap;
+  return offset;
+}
+
+template <class... Types>
+void vector<Types...>::copy_from(const vector& rhs) {
+  reserve_entries(rhs.entries);
+  reserve_cap(rhs.used);
+  if (rhs.size_ > 0) {
+    std::memcpy(offsets, rhs.offsets, rhs.size_ * sizeof(std::size_t));
+    std::memcpy(tags, rhs.tags, tag_bytes(rhs.size_));
+  }
+  for (; size_ < rhs.size_; size_++) {
+    ctable[type_index(size_)](data + offsets[size_], rhs.data + offsets[size_]);
+  }
+  used = rhs.used;
+}
+
+template <class... Types> void vector<Types...>::delete_data() {
+  for (std::size_t i = 0; i < size_; i++) {
+    dtable[type_index(i)](data + offsets[i]);
+  }
+  ::operator delete(data, std::align_val_t{max_align});
+  delete[] offsets;
+  delete[] tags;
+}
+
+template <class... Types> void vector<Types...>::reset() {
+  size_ = 0;
+  capacity = 0;
+  entries = 0;
+  used = 0;
+  data = nullptr;
+  offsets = nullptr;
+  tags = nullptr;
+}
+
 } // namespace vv5
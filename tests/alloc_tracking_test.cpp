@@ -0,0 +1,102 @@
+#define VV_TRACK_GLOBAL_ALLOCATIONS
+#include "../include/alloc_tracking.hpp"
+#include "../include/vv3.hpp"
+#include <gtest/gtest.h>
+#include <cstddef>
+#include <string>
+
+using alloc_tracking::scope;
+using alloc_tracking::stats;
+using alloc_tracking::tracking_allocator;
+
+// raw operator new calls, since new-expressions may be elided in pairs.
+// failing EXPECTs allocate, so everything is read before checking
+TEST(AllocTrackingTest, ScopeCountsNewAndDelete) {
+  scope s;
+  void* p = ::operator new(24);
+  void* q = ::operator new(40, std::align_val_t{64});
+  std::size_t allocations = s.allocations();
+  std::size_t held = s.held();
+  ::operator delete(p);
+  ::operator delete(q, std::align_val_t{64});
+  std::size_t deallocations = s.deallocations();
+  std::size_t held_after = s.held();
+
+  EXPECT_EQ(allocations, 2u);
+  EXPECT_EQ(held, 64u);
+  EXPECT_EQ(deallocations, 2u);
+  EXPECT_EQ(held_after, 0u);
+  EXPECT_EQ(s.peak_above(), 64u);
+}
+
+// entries grow 1, 3, 7, ..., 1023 and the int payload keeps up, so 1000
+// push_backs cost ceil(log2(1001)) = 10 blocks, each freeing its predecessor
+TEST(AllocTrackingTest, PushBacksGrowGeometrically) {
+  scope s;
+  {
+    vv3::vector<int, double> vec;
+    for (int i = 0; i < 1000; i++) {
+      vec.push_back(i);
+    }
+    EXPECT_EQ(s.allocations(), 10u);
+    EXPECT_EQ(s.deallocations(), 9u);
+  }
+  EXPECT_EQ(s.deallocations(), 10u);
+  EXPECT_EQ(s.held(), 0u);
+}
+
+TEST(AllocTrackingTest, ReserveForMakesAppendsAllocationFree) {
+  vv3::vector<int, double> vec;
+  scope s;
+  vec.reserve_for<int, double>(500, 500);
+  EXPECT_EQ(s.allocations(), 1u);
+  for (int i = 0; i < 1000; i++) {
+    if (i % 2) {
+      vec.push_back(i);
+    } else {
+      vec.push_back(static_cast<double>(i));
+    }
+  }
+  EXPECT_EQ(s.allocations(), 1u);
+  EXPECT_EQ(s.deallocations(), 0u);
+}
+
+// the vector's block comes from its allocator, so per-container stats see
+// exactly what the global hook sees
+TEST(AllocTrackingTest, TrackingAllocatorMatchesGlobalHook) {
+  stats local;
+  scope global_scope;
+  {
+    vv3::basic_vector<tracking_allocator<std::byte>, char, int, std::string>
+        vec{tracking_allocator<std::byte>(local)};
+    for (int i = 0; i < 300; i++) {
+      vec.push_back(static_cast<char>(i));
+      vec.push_back(i);
+    }
+    EXPECT_EQ(local.allocations, global_scope.allocations());
+    EXPECT_EQ(local.live, global_scope.held());
+    EXPECT_EQ(local.peak, global_scope.peak_above());
+  }
+  EXPECT_EQ(local.allocations, local.deallocations);
+  EXPECT_EQ(local.live, 0u);
+}
+
+TEST(AllocTrackingTest, CopyIsOneBlockAndMoveIsFree) {
+  vv3::vector<char, int, double> vec;
+  for (int i = 0; i < 300; i++) {
+    vec.push_back(static_cast<char>(i));
+    vec.push_back(i);
+    vec.push_back(static_cast<double>(i));
+  }
+
+  scope copying;
+  auto copy = vec;
+  std::size_t copy_allocations = copying.allocations();
+
+  scope moving;
+  auto moved = std::move(copy);
+  std::size_t move_allocations = moving.allocations();
+
+  EXPECT_EQ(copy_allocations, 1u);
+  EXPECT_EQ(move_allocations, 0u);
+}
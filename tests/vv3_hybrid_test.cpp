@@ -0,0 +1,187 @@
+#include "../include/vv3_hybrid.hpp"
+#include <gtest/gtest.h>
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <string>
+#include <typeinfo>
+
+struct Big {
+  std::array<char, 512> bytes{};
+  int id = 0;
+
+  Big() = default;
+  explicit Big(int id) : id(id) {}
+};
+
+struct Live {
+  static inline int count = 0;
+
+  std::array<char, 256> pad{};
+
+  Live() { ++count; }
+  Live(const Live&) { ++count; }
+  Live(Live&&) noexcept { ++count; }
+  ~Live() { --count; }
+};
+
+// counts what it hands out, then forwards to new_delete_resource()
+struct CountingResource : std::pmr::memory_resource {
+  int allocations = 0;
+
+private:
+  void* do_allocate(std::size_t bytes, std::size_t align) override {
+    allocations++;
+    return std::pmr::new_delete_resource()->allocate(bytes, align);
+  }
+
+  void do_deallocate(void* p, std::size_t bytes, std::size_t align) override {
+    std::pmr::new_delete_resource()->deallocate(p, bytes, align);
+  }
+
+  bool do_is_equal(const memory_resource& other) const noexcept override {
+    return this == &other;
+  }
+};
+
+using vec_t = vv3::hybrid_vector<64, int, std::string, Big>;
+
+TEST(HybridVectorTest, ThresholdPicksStorage) {
+  EXPECT_TRUE(vec_t::is_inline<int>);
+  EXPECT_TRUE(vec_t::is_inline<std::string>);
+  EXPECT_FALSE(vec_t::is_inline<Big>);
+}
+
+TEST(HybridVectorTest, PushAndGet) {
+  vec_t vec;
+  vec.push_back(1);
+  vec.push_back(Big(7));
+  vec.push_back(std::string("small"));
+  Big& b = vec.emplace_back<Big>(9);
+
+  ASSERT_EQ(vec.size(), 4u);
+  EXPECT_EQ(vec.get<int>(0), 1);
+  EXPECT_EQ(vec.get<Big>(1).id, 7);
+  EXPECT_EQ(vec.get<std::string>(2), "small");
+  EXPECT_EQ(&vec.get<Big>(3), &b);
+  EXPECT_THROW((void)vec.get<Big>(0), std::bad_cast);
+}
+
+// big elements stay where they are when the inline buffer grows
+TEST(HybridVectorTest, BigElementsAreNotRelocated) {
+  vec_t vec;
+  Big& first = vec.emplace_back<Big>(1);
+  for (int i = 0; i < 1000; i++) {
+    vec.push_back(i);
+  }
+  EXPECT_EQ(&vec.get<Big>(0), &first);
+  EXPECT_EQ(first.id, 1);
+}
+
+TEST(HybridVectorTest, IndexVisitAndIterateSeeTheElement) {
+  vec_t vec;
+  vec.push_back(Big(3));
+  vec.push_back(5);
+
+  auto e = vec[0];
+  EXPECT_EQ(e.type_index, 2u);
+  EXPECT_EQ(reinterpret_cast<Big*>(e.data)->id, 3);
+
+  int sum = 0;
+  auto add = [&](auto& x) {
+    if constexpr (std::is_same_v<std::decay_t<decltype(x)>, Big>) {
+      sum += x.id;
+    } else if constexpr (std::is_same_v<std::decay_t<decltype(x)>, int>) {
+      sum += x;
+    }
+  };
+  vec.for_each(add);
+  EXPECT_EQ(sum, 8);
+  vec.visit(0, add);
+  EXPECT_EQ(sum, 11);
+
+  std::size_t i = 0;
+  for (auto it : vec) {
+    EXPECT_EQ(it.data, vec[i++].data);
+  }
+  EXPECT_EQ(i, 2u);
+
+  EXPECT_EQ(vec.count_type<Big>(), 1u);
+  EXPECT_EQ(vec.find_type<int>(), 1u);
+}
+
+TEST(HybridVectorTest, CopyMoveAndDestroy) {
+  Live::count = 0;
+  {
+    vv3::hybrid_vector<64, int, Live> vec;
+    for (int i = 0; i < 10; i++) {
+      vec.emplace_back<Live>();
+      vec.push_back(i);
+    }
+    EXPECT_EQ(Live::count, 10);
+
+    auto copy = vec;
+    EXPECT_EQ(Live::count, 20);
+    EXPECT_NE(&copy.get<Live>(0), &vec.get<Live>(0));
+
+    Live* p = &vec.get<Live>(2);
+    auto moved = std::move(vec);
+    EXPECT_EQ(&moved.get<Live>(2), p);
+    EXPECT_EQ(Live::count, 20);
+  }
+  EXPECT_EQ(Live::count, 0);
+}
+
+TEST(HybridVectorTest, PmrPoolBacksBigElements) {
+  std::pmr::unsynchronized_pool_resource pool;
+  vv3::pmr::hybrid_vector<64, int, Big> vec(&pool);
+  for (int i = 0; i < 100; i++) {
+    vec.emplace_back<Big>(i);
+    vec.push_back(i);
+  }
+  EXPECT_EQ(vec.get<Big>(198).id, 99);
+  EXPECT_EQ(vec.get_allocator().resource(), &pool);
+}
+
+// the boxes have to leave the source's resource, which goes away first
+TEST(HybridVectorTest, MoveAcrossResourcesReboxes) {
+  std::pmr::unsynchronized_pool_resource dst_pool;
+  vv3::pmr::hybrid_vector<64, int, Big> dst(&dst_pool);
+  dst.emplace_back<Big>(-1);
+  {
+    auto src_pool = std::make_unique<std::pmr::unsynchronized_pool_resource>();
+    vv3::pmr::hybrid_vector<64, int, Big> src(src_pool.get());
+    for (int i = 0; i < 10; i++) {
+      src.emplace_back<Big>(i);
+      src.push_back(i);
+    }
+    dst = std::move(src);
+    EXPECT_EQ(src.size(), 0u);
+  }
+  ASSERT_EQ(dst.size(), 20u);
+  EXPECT_EQ(dst.get_allocator().resource(), &dst_pool);
+  for (int i = 0; i < 10; i++) {
+    EXPECT_EQ(dst.get<Big>(2 * static_cast<std::size_t>(i)).id, i);
+    EXPECT_EQ(dst.get<int>(2 * static_cast<std::size_t>(i) + 1), i);
+  }
+}
+
+TEST(HybridVectorTest, CopyAssignBoxesFromTheDestination) {
+  CountingResource r1, r2;
+  vv3::pmr::hybrid_vector<64, int, Big> a(&r1);
+  for (int i = 0; i < 10; i++) {
+    a.emplace_back<Big>(i);
+    a.push_back(i);
+  }
+  int a_allocations = r1.allocations;
+
+  vv3::pmr::hybrid_vector<64, int, Big> b(&r2);
+  b = a;
+  EXPECT_EQ(r1.allocations, a_allocations);
+  // one block and a box per Big
+  EXPECT_GE(r2.allocations, 11);
+  EXPECT_EQ(b.get_allocator().resource(), &r2);
+  EXPECT_NE(&b.get<Big>(4), &a.get<Big>(4));
+  EXPECT_EQ(b.get<Big>(4).id, 2);
+}
@@ -0,0 +1,103 @@
+#include "../include/vv3_indexed.hpp"
+#include <algorithm>
+#include <gtest/gtest.h>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+TEST(IndexedVectorTest, CountsPerAlternative) {
+  vv3::indexed_vector<int, std::string, double> vec;
+  EXPECT_EQ(vec.count<int>(), 0u);
+
+  for (int i = 0; i < 30; i++) {
+    if (i % 3 == 0) {
+      vec.push_back(i);
+    } else if (i % 3 == 1) {
+      vec.push_back(std::to_string(i));
+    } else {
+      vec.push_back(static_cast<double>(i));
+    }
+  }
+
+  EXPECT_EQ(vec.size(), 30u);
+  EXPECT_EQ(vec.count<int>(), 10u);
+  EXPECT_EQ(vec.count<std::string>(), 10u);
+  EXPECT_EQ(vec.count<double>(), 10u);
+}
+
+TEST(IndexedVectorTest, IndicesOfMatchTags) {
+  vv3::indexed_vector<int, std::string, double> vec;
+  vec.push_back(1);
+  vec.push_back(std::string("a"));
+  vec.push_back(2);
+  vec.emplace_back<double>(3.0);
+  vec.emplace_back(std::in_place_type<std::string>, "b");
+
+  auto ints = vec.indices_of<int>();
+  EXPECT_EQ(std::vector<std::size_t>(ints.begin(), ints.end()),
+            (std::vector<std::size_t>{0, 2}));
+  auto strings = vec.indices_of<std::string>();
+  EXPECT_EQ(std::vector<std::size_t>(strings.begin(), strings.end()),
+            (std::vector<std::size_t>{1, 4}));
+
+  for (std::size_t i = 0; i < vec.size(); i++) {
+    auto e = vec[i];
+    auto idx = e.type_index == 0   ? vec.indices_of<int>()
+               : e.type_index == 1 ? vec.indices_of<std::string>()
+                                   : vec.indices_of<double>();
+    EXPECT_NE(std::find(idx.begin(), idx.end(), i), idx.end());
+  }
+}
+
+TEST(IndexedVectorTest, ForEachOfVisitsOnlyMatches) {
+  vv3::indexed_vector<int, std::string> vec;
+  for (int i = 0; i < 10; i++) {
+    vec.push_back(i);
+    vec.push_back(std::to_string(i));
+  }
+
+  int sum = 0;
+  vec.for_each_of<int>([&](int& x) { sum += x; });
+  EXPECT_EQ(sum, 45);
+
+  std::string joined;
+  vec.for_each_of<std::string>([&](std::string& s) { joined += s; });
+  EXPECT_EQ(joined, "0123456789");
+
+  vec.for_each_of<int>([](int& x) { x *= 2; });
+  EXPECT_EQ(vec.get<int>(18), 18);
+}
+
+TEST(IndexedVectorTest, CopyAndMoveKeepIndex) {
+  vv3::indexed_vector<int, std::string> vec;
+  vec.push_back(std::string("x"));
+  vec.push_back(7);
+
+  auto copy = vec;
+  EXPECT_EQ(copy.count<int>(), 1u);
+  EXPECT_EQ(copy.get<int>(copy.indices_of<int>()[0]), 7);
+
+  auto moved = std::move(copy);
+  EXPECT_EQ(moved.count<std::string>(), 1u);
+  EXPECT_EQ(moved.get<std::string>(0), "x");
+}
+
+struct Throws {
+  explicit Throws(bool fail) {
+    if (fail) {
+      throw std::runtime_error("fail");
+    }
+  }
+};
+
+TEST(IndexedVectorTest, ThrowingAppendLeavesIndexConsistent) {
+  vv3::indexed_vector<int, Throws> vec;
+  vec.push_back(1);
+  vec.emplace_back<Throws>(false);
+  EXPECT_THROW(vec.emplace_back<Throws>(true), std::runtime_error);
+
+  EXPECT_EQ(vec.size(), 2u);
+  EXPECT_EQ(vec.count<Throws>(), 1u);
+  vec.push_back(2);
+  EXPECT_EQ(vec.indices_of<int>()[1], 2u);
+}
@@ -0,0 +1,102 @@
+#include "../include/vv3.hpp"
+#include "../include/vv3_packed.hpp"
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <cstring>
+#include <typeinfo>
+
+using packed_t = vv3::packed_vector<char, short, int, double>;
+
+TEST(PackedVectorTest, DefaultConstructor) {
+  packed_t vec;
+  EXPECT_EQ(vec.size(), 0u);
+  EXPECT_EQ(vec.payload_bytes(), 0u);
+}
+
+TEST(PackedVectorTest, LoadAndStoreRoundTrip) {
+  packed_t vec;
+  vec.push_back('c');
+  vec.push_back(2.5);
+  vec.push_back(static_cast<short>(7));
+  vec.push_back(42);
+
+  EXPECT_EQ(vec.size(), 4u);
+  EXPECT_EQ(vec.load<char>(0), 'c');
+  EXPECT_DOUBLE_EQ(vec.load<double>(1), 2.5);
+  EXPECT_EQ(vec.load<short>(2), 7);
+  EXPECT_EQ(vec.load<int>(3), 42);
+  EXPECT_THROW((void)vec.load<int>(0), std::bad_cast);
+
+  vec.store(1, 6.25);
+  vec.store(3, -1);
+  EXPECT_DOUBLE_EQ(vec.load<double>(1), 6.25);
+  EXPECT_EQ(vec.load<int>(3), -1);
+  EXPECT_EQ(vec.load<char>(0), 'c');
+  EXPECT_THROW(vec.store(0, 1), std::bad_cast);
+
+  // the double right after a char is misaligned, but [] still hands out its
+  // bytes
+  auto e = vec[1];
+  EXPECT_EQ(e.type_index, 3u);
+  double d = 0;
+  std::memcpy(&d, e.data, sizeof(d));
+  EXPECT_DOUBLE_EQ(d, 6.25);
+}
+
+// char, double alternating: vv3 pads 7 bytes before every double
+TEST(PackedVectorTest, PayloadHasNoPadding) {
+  packed_t vec;
+  vv3::vector<char, short, int, double> padded;
+  for (int i = 0; i < 1000; i++) {
+    if (i % 2 == 0) {
+      vec.push_back(static_cast<char>(i));
+      padded.push_back(static_cast<char>(i));
+    } else {
+      vec.push_back(static_cast<double>(i));
+      padded.push_back(static_cast<double>(i));
+    }
+  }
+
+  EXPECT_EQ(vec.payload_bytes(), 500 * (sizeof(char) + sizeof(double)));
+  EXPECT_EQ(padded.payload_bytes(), vec.payload_bytes());
+  EXPECT_GT(padded.padding_bytes(), 0u);
+  for (int i = 0; i < 1000; i++) {
+    if (i % 2 == 0) {
+      EXPECT_EQ(vec.load<char>(i), static_cast<char>(i));
+    } else {
+      EXPECT_DOUBLE_EQ(vec.load<double>(i), padded.get<double>(i));
+    }
+  }
+}
+
+TEST(PackedVectorTest, VisitWritesBack) {
+  packed_t vec;
+  for (int i = 0; i < 10; i++) {
+    vec.push_back('x');
+    vec.push_back(static_cast<double>(i));
+  }
+
+  vec.for_each([](auto& x) {
+    if constexpr (std::is_same_v<std::decay_t<decltype(x)>, double>) {
+      x *= 2;
+    }
+  });
+  EXPECT_DOUBLE_EQ(vec.load<double>(19), 18.0);
+  EXPECT_EQ(vec.load<char>(18), 'x');
+
+  double sum = 0;
+  vec.for_each([&](auto& x) {
+    if constexpr (std::is_same_v<std::decay_t<decltype(x)>, double>) {
+      sum += x;
+    }
+  });
+  EXPECT_DOUBLE_EQ(sum, 90.0);
+
+  EXPECT_EQ(vec.visit(1, [](auto& x) -> std::size_t { return sizeof(x); }),
+            sizeof(double));
+
+  auto copy = vec;
+  copy.store(1, 100.0);
+  EXPECT_DOUBLE_EQ(vec.load<double>(1), 0.0);
+  EXPECT_DOUBLE_EQ(copy.load<double>(1), 100.0);
+}
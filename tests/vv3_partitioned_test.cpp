@@ -0,0 +1,123 @@
+#include "../include/vv3_partitioned.hpp"
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <typeinfo>
+
+using part_t = vv3::partitioned_vector<char, int, double, std::string>;
+
+TEST(PartitionedVectorTest, DefaultConstructor) {
+  part_t vec;
+  EXPECT_EQ(vec.size(), 0u);
+  EXPECT_EQ(vec.count_type<int>(), 0u);
+  EXPECT_EQ(vec.begin(), vec.end());
+}
+
+TEST(PartitionedVectorTest, PushBackAndGet) {
+  part_t vec;
+  vec.push_back('c');
+  vec.push_back(42);
+  vec.push_back(2.5);
+  vec.push_back(std::string("hello"));
+  vec.push_back(7);
+
+  EXPECT_EQ(vec.size(), 5u);
+  EXPECT_EQ(vec.get<char>(0), 'c');
+  EXPECT_EQ(vec.get<int>(1), 42);
+  EXPECT_DOUBLE_EQ(vec.get<double>(2), 2.5);
+  EXPECT_EQ(vec.get<std::string>(3), "hello");
+  EXPECT_EQ(vec.get<int>(4), 7);
+  EXPECT_THROW((void)vec.get<int>(0), std::bad_cast);
+
+  EXPECT_EQ(vec[4].type_index, 1u);
+  EXPECT_EQ(*reinterpret_cast<int*>(vec[4].data), 7);
+}
+
+// each alternative is one dense array, in logical order, with no padding
+TEST(PartitionedVectorTest, AlternativesAreDenseArrays) {
+  part_t vec;
+  for (int i = 0; i < 1000; i++) {
+    if (i % 3 == 0) {
+      vec.push_back(static_cast<char>(i));
+    } else {
+      vec.push_back(i);
+    }
+  }
+
+  auto ints = vec.array_of<int>();
+  ASSERT_EQ(ints.size(), vec.count_type<int>());
+  EXPECT_EQ(ints.size(), 666u);
+  for (std::size_t k = 1; k < ints.size(); k++) {
+    EXPECT_EQ(reinterpret_cast<const std::byte*>(&ints[k]) -
+                  reinterpret_cast<const std::byte*>(&ints[k - 1]),
+              static_cast<std::ptrdiff_t>(sizeof(int)));
+    EXPECT_LT(ints[k - 1], ints[k]);
+  }
+
+  long long sum = 0;
+  vec.for_each_of<int>([&](int x) { sum += x; });
+  long long expected = 0;
+  for (int i = 0; i < 1000; i++) {
+    expected += i % 3 == 0 ? 0 : i;
+  }
+  EXPECT_EQ(sum, expected);
+
+  EXPECT_EQ(vec.find_type<int>(), 1u);
+  EXPECT_EQ(vec.find_type<char>(1), 3u);
+  EXPECT_EQ(vec.find_type<double>(), vec.size());
+}
+
+TEST(PartitionedVectorTest, VisitIterateAndCopy) {
+  part_t vec;
+  for (int i = 0; i < 100; i++) {
+    vec.push_back(i);
+    vec.push_back(std::string(20, 'x'));
+  }
+
+  long long sum = 0;
+  vec.for_each([&](auto& x) {
+    if constexpr (std::is_same_v<std::decay_t<decltype(x)>, int>) {
+      sum += x;
+    }
+  });
+  EXPECT_EQ(sum, 4950);
+
+  std::size_t i = 0;
+  for (auto e : vec) {
+    EXPECT_EQ(e.data, vec[i++].data);
+  }
+  EXPECT_EQ(i, vec.size());
+
+  EXPECT_EQ(vec.visit(3, [](auto& x) -> std::size_t { return sizeof(x); }),
+            sizeof(std::string));
+
+  auto copy = vec;
+  EXPECT_EQ(copy.size(), vec.size());
+  EXPECT_NE(copy[1].data, vec[1].data);
+  EXPECT_EQ(copy.get<std::string>(199), std::string(20, 'x'));
+
+  auto moved = std::move(copy);
+  EXPECT_EQ(moved.get<int>(198), 99);
+}
+
+struct Throws {
+  explicit Throws(bool fail) {
+    if (fail) {
+      throw std::runtime_error("fail");
+    }
+  }
+};
+
+TEST(PartitionedVectorTest, ThrowingAppendLeavesVectorUnchanged) {
+  vv3::partitioned_vector<int, Throws> vec;
+  vec.push_back(1);
+  EXPECT_THROW(vec.emplace_back<Throws>(true), std::runtime_error);
+  EXPECT_EQ(vec.size(), 1u);
+  EXPECT_EQ(vec.count_type<Throws>(), 0u);
+  vec.emplace_back<Throws>(false);
+  vec.push_back(2);
+  EXPECT_EQ(vec.get<int>(2), 2);
+  EXPECT_EQ(vec[1].type_index, 1u);
+}
@@ -0,0 +1,164 @@
+#include "../include/vv3_rle.hpp"
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <typeinfo>
+
+using rle_t = vv3::rle_vector<char, int, double, std::string>;
+
+TEST(RleVectorTest, DefaultConstructor) {
+  rle_t vec;
+  EXPECT_EQ(vec.size(), 0u);
+  EXPECT_EQ(vec.run_count(), 0u);
+  EXPECT_EQ(vec.begin(), vec.end());
+}
+
+TEST(RleVectorTest, RunsMergeConsecutiveAlternatives) {
+  rle_t vec;
+  for (int i = 0; i < 100; i++) {
+    vec.push_back(i);
+  }
+  vec.push_back('c');
+  for (int i = 0; i < 50; i++) {
+    vec.push_back(static_cast<double>(i));
+  }
+  vec.push_back(std::string("tail"));
+
+  EXPECT_EQ(vec.size(), 152u);
+  EXPECT_EQ(vec.run_count(), 4u);
+  EXPECT_EQ(vec.count_type<int>(), 100u);
+  EXPECT_EQ(vec.count_type<double>(), 50u);
+
+  EXPECT_EQ(vec.get<int>(0), 0);
+  EXPECT_EQ(vec.get<int>(99), 99);
+  EXPECT_EQ(vec.get<char>(100), 'c');
+  EXPECT_DOUBLE_EQ(vec.get<double>(101), 0.0);
+  EXPECT_DOUBLE_EQ(vec.get<double>(150), 49.0);
+  EXPECT_EQ(vec.get<std::string>(151), "tail");
+  EXPECT_THROW((void)vec.get<int>(100), std::bad_cast);
+
+  // only the start of a run is padded
+  EXPECT_EQ(reinterpret_cast<std::uintptr_t>(vec[101].data) % alignof(double),
+            0u);
+  EXPECT_EQ(vec[102].data - vec[101].data,
+            static_cast<std::ptrdiff_t>(sizeof(double)));
+}
+
+// int, char, std::string in runs of 10
+std::size_t expected_tag(std::size_t i) {
+  return i / 10 % 3 == 0 ? 1 : i / 10 % 3 == 1 ? 0 : 3;
+}
+
+TEST(RleVectorTest, IterationAndVisitMatchIndexing) {
+  rle_t vec;
+  for (int i = 0; i < 300; i++) {
+    if (i / 10 % 3 == 0) {
+      vec.push_back(i);
+    } else if (i / 10 % 3 == 1) {
+      vec.push_back(static_cast<char>(i));
+    } else {
+      vec.push_back(std::to_string(i));
+    }
+  }
+  EXPECT_EQ(vec.run_count(), 30u);
+
+  std::size_t i = 0;
+  for (auto e : vec) {
+    auto expected = vec[i++];
+    EXPECT_EQ(e.type_index, expected.type_index);
+    EXPECT_EQ(e.data, expected.data);
+  }
+  EXPECT_EQ(i, vec.size());
+
+  // backwards and strided lookups miss the run hint
+  for (std::size_t k = vec.size(); k-- > 0;) {
+    EXPECT_EQ(vec[k].type_index, expected_tag(k));
+  }
+  for (std::size_t k = 0; k < vec.size(); k += 37) {
+    EXPECT_EQ(vec[k].type_index, expected_tag(k));
+  }
+
+  long long sum = 0;
+  std::size_t visited = 0;
+  vec.for_each([&](auto& x) {
+    visited++;
+    if constexpr (std::is_same_v<std::decay_t<decltype(x)>, int>) {
+      sum += x;
+    }
+  });
+  EXPECT_EQ(visited, vec.size());
+  long long expected_sum = 0;
+  for (int k = 0; k < 300; k++) {
+    expected_sum += k / 10 % 3 == 0 ? k : 0;
+  }
+  EXPECT_EQ(sum, expected_sum);
+
+  EXPECT_EQ(vec.visit(25, [](auto& x) -> std::size_t { return sizeof(x); }),
+            sizeof(std::string));
+}
+
+TEST(RleVectorTest, ForEachRunHandsOutTypedSpans) {
+  rle_t vec;
+  for (int i = 0; i < 10; i++) {
+    vec.push_back(i);
+  }
+  vec.push_back(std::string("x"));
+  vec.push_back(std::string("y"));
+
+  std::vector<std::size_t> lengths;
+  int int_total = 0;
+  vec.for_each_run([&]<class T>(std::span<T> run) {
+    lengths.push_back(run.size());
+    if constexpr (std::is_same_v<T, int>) {
+      for (int x : run) {
+        int_total += x;
+      }
+    }
+  });
+  EXPECT_EQ(lengths, (std::vector<std::size_t>{10, 2}));
+  EXPECT_EQ(int_total, 45);
+}
+
+TEST(RleVectorTest, CopyAndMove) {
+  rle_t vec;
+  for (int i = 0; i < 100; i++) {
+    vec.push_back(std::string(20, 'a' + i % 26));
+    vec.push_back(i);
+  }
+
+  auto copy = vec;
+  EXPECT_EQ(copy.size(), vec.size());
+  EXPECT_EQ(copy.run_count(), vec.run_count());
+  EXPECT_NE(copy[0].data, vec[0].data);
+  EXPECT_EQ(copy.get<std::string>(198), std::string(20, 'a' + 99 % 26));
+
+  auto moved = std::move(copy);
+  EXPECT_EQ(moved.get<int>(199), 99);
+  EXPECT_EQ(copy.size(), 0u);
+  copy.push_back(1);
+  EXPECT_EQ(copy.get<int>(0), 1);
+
+  copy = moved;
+  EXPECT_EQ(copy.get<int>(1), 0);
+}
+
+struct Throws {
+  explicit Throws(bool fail) {
+    if (fail) {
+      throw std::runtime_error("fail");
+    }
+  }
+};
+
+TEST(RleVectorTest, ThrowingAppendLeavesVectorUnchanged) {
+  vv3::rle_vector<int, Throws> vec;
+  vec.push_back(1);
+  EXPECT_THROW(vec.emplace_back<Throws>(true), std::runtime_error);
+  EXPECT_EQ(vec.size(), 1u);
+  EXPECT_EQ(vec.run_count(), 1u);
+  vec.push_back(2);
+  EXPECT_EQ(vec.get<int>(1), 2);
+  EXPECT_EQ(vec.run_count(), 1u);
+}
@@ -0,0 +1,120 @@
+#include "../include/vv3_segmented.hpp"
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <typeinfo>
+#include <vector>
+
+using seg_t = vv3::segmented_vector<256, char, int, double, std::string>;
+
+TEST(SegmentedVectorTest, DefaultConstructor) {
+  seg_t vec;
+  EXPECT_EQ(vec.size(), 0u);
+  EXPECT_EQ(vec.chunk_count(), 0u);
+  EXPECT_EQ(vec.begin(), vec.end());
+}
+
+TEST(SegmentedVectorTest, PushBackAndGet) {
+  seg_t vec;
+  vec.push_back('c');
+  vec.push_back(42);
+  vec.push_back(2.5);
+  vec.push_back(std::string("hello"));
+
+  EXPECT_EQ(vec.get<char>(0), 'c');
+  EXPECT_EQ(vec.get<int>(1), 42);
+  EXPECT_DOUBLE_EQ(vec.get<double>(2), 2.5);
+  EXPECT_EQ(vec.get<std::string>(3), "hello");
+  EXPECT_THROW((void)vec.get<int>(0), std::bad_cast);
+  EXPECT_EQ(vec.chunk_count(), 1u);
+}
+
+// the point of the container: nothing moves while it grows
+TEST(SegmentedVectorTest, ReferencesStayValidAcrossGrowth) {
+  seg_t vec;
+  std::vector<const void*> addresses;
+  for (int i = 0; i < 2000; i++) {
+    switch (i % 4) {
+    case 0:
+      addresses.push_back(&vec.emplace_back<char>(static_cast<char>(i)));
+      break;
+    case 1:
+      addresses.push_back(&vec.emplace_back<int>(i));
+      break;
+    case 2:
+      addresses.push_back(&vec.emplace_back<double>(i));
+      break;
+    default:
+      addresses.push_back(&vec.emplace_back<std::string>(std::to_string(i)));
+      break;
+    }
+  }
+
+  EXPECT_GT(vec.chunk_count(), 10u);
+  for (std::size_t i = 0; i < vec.size(); i++) {
+    auto e = vec[i];
+    EXPECT_EQ(e.data, addresses[i]);
+    EXPECT_EQ(e.type_index, i % 4);
+    EXPECT_EQ(reinterpret_cast<std::uintptr_t>(e.data) %
+                  (i % 4 == 0 ? 1 : i % 4 == 1 ? alignof(int)
+                                : i % 4 == 2   ? alignof(double)
+                                               : alignof(std::string)),
+              0u);
+  }
+  EXPECT_EQ(vec.get<std::string>(1999), "1999");
+}
+
+TEST(SegmentedVectorTest, VisitIterateAndCopy) {
+  seg_t vec;
+  for (int i = 0; i < 100; i++) {
+    vec.push_back(i);
+    vec.push_back(std::string(20, 'x'));
+  }
+
+  long long sum = 0;
+  vec.for_each([&](auto& x) {
+    if constexpr (std::is_same_v<std::decay_t<decltype(x)>, int>) {
+      sum += x;
+    }
+  });
+  EXPECT_EQ(sum, 4950);
+
+  std::size_t i = 0;
+  for (auto e : vec) {
+    EXPECT_EQ(e.data, vec[i++].data);
+  }
+  EXPECT_EQ(i, vec.size());
+
+  auto copy = vec;
+  EXPECT_EQ(copy.size(), vec.size());
+  EXPECT_NE(copy[1].data, vec[1].data);
+  EXPECT_EQ(copy.get<std::string>(199), std::string(20, 'x'));
+
+  const void* p = vec[5].data;
+  auto moved = std::move(vec);
+  EXPECT_EQ(moved[5].data, p);
+  EXPECT_EQ(vec.size(), 0u);
+  vec.push_back(1);
+  EXPECT_EQ(vec.get<int>(0), 1);
+
+  copy = moved;
+  EXPECT_EQ(copy.get<int>(198), 99);
+}
+
+struct Throws {
+  explicit Throws(bool fail) {
+    if (fail) {
+      throw std::runtime_error("fail");
+    }
+  }
+};
+
+TEST(SegmentedVectorTest, ThrowingAppendLeavesVectorUnchanged) {
+  vv3::segmented_vector<64, int, Throws> vec;
+  vec.push_back(1);
+  EXPECT_THROW(vec.emplace_back<Throws>(true), std::runtime_error);
+  EXPECT_EQ(vec.size(), 1u);
+  vec.push_back(2);
+  EXPECT_EQ(vec.get<int>(1), 2);
+}
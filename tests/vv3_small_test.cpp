@@ -0,0 +1,368 @@
+#include "../include/vv3.hpp"
+#include <gtest/gtest.h>
+#include <string>
+
+struct Tracker {
+  static int constructions;
+  static int destructions;
+
+  Tracker() { ++constructions; }
+  Tracker(const Tracker&) { ++constructions; }
+  Tracker(Tracker&&) noexcept = default;
+  ~Tracker() { ++destructions; }
+
+  static void reset() {
+    constructions = 0;
+    destructions = 0;
+  }
+};
+
+int Tracker::constructions = 0;
+int Tracker::destructions = 0;
+
+using vv3::Element;
+
+// runs the vv3::vector cases against a few inline sizes, from one that spills
+// almost immediately to one that holds every case inline
+template <std::size_t Bytes> struct Small {
+  template <class... Types> using type = vv3::small_vector<Bytes, Types...>;
+};
+
+template <class T> class SmallVectorTest : public ::testing::Test {};
+
+using InlineSizes = ::testing::Types<Small<64>, Small<256>, Small<4096>>;
+TYPED_TEST_SUITE(SmallVectorTest, InlineSizes);
+
+TYPED_TEST(SmallVectorTest, DefaultConstructor) {
+  typename TypeParam::template type<int, std::string, double> vec;
+  EXPECT_EQ(vec.size(), 0u);
+  EXPECT_TRUE(vec.is_inline());
+}
+
+TYPED_TEST(SmallVectorTest, PushBackDifferentTypes) {
+  typename TypeParam::template type<int, std::string, double> vec;
+
+  int a = 42;
+  vec.push_back(a);
+  EXPECT_EQ(vec.size(), 1u);
+  EXPECT_EQ(vec.template get<int>(0), 42);
+
+  std::string s = "hello";
+  vec.push_back(s);
+  EXPECT_EQ(vec.size(), 2u);
+  EXPECT_EQ(vec.template get<std::string>(1), "hello");
+
+  double d = 3.14;
+  vec.push_back(d);
+  EXPECT_EQ(vec.size(), 3u);
+  EXPECT_DOUBLE_EQ(vec.template get<double>(2), 3.14);
+}
+
+TYPED_TEST(SmallVectorTest, AccessElementsOperator) {
+  typename TypeParam::template type<int, std::string> vec;
+  vec.push_back(100);
+  std::string hello = "world";
+  vec.push_back(hello);
+
+  Element e0 = vec[0];
+  EXPECT_EQ(e0.type_index, 0u);
+  EXPECT_EQ(*reinterpret_cast<int*>(e0.data), 100);
+
+  Element e1 = vec[1];
+  EXPECT_EQ(e1.type_index, 1u);
+  EXPECT_EQ(*reinterpret_cast<std::string*>(e1.data), "world");
+}
+
+TYPED_TEST(SmallVectorTest, CopyConstructor) {
+  typename TypeParam::template type<int, std::string> vec1;
+  vec1.push_back(10);
+  vec1.push_back(std::string("copy"));
+
+  auto vec2 = vec1;
+  EXPECT_EQ(vec2.size(), 2u);
+  EXPECT_EQ(vec2.template get<int>(0), 10);
+  EXPECT_EQ(vec2.template get<std::string>(1), "copy");
+}
+
+TYPED_TEST(SmallVectorTest, MoveConstructor) {
+  typename TypeParam::template type<int, std::string> vec1;
+  vec1.push_back(20);
+  vec1.push_back(std::string("move"));
+
+  auto vec2 = std::move(vec1);
+  EXPECT_EQ(vec2.size(), 2u);
+  EXPECT_EQ(vec2.template get<int>(0), 20);
+  EXPECT_EQ(vec2.template get<std::string>(1), "move");
+
+  EXPECT_EQ(vec1.size(), 0u);
+}
+
+TYPED_TEST(SmallVectorTest, CopyAssignment) {
+  typename TypeParam::template type<int, std::string> vec1;
+  vec1.push_back(30);
+  vec1.push_back(std::string("assign"));
+
+  typename TypeParam::template type<int, std::string> vec2;
+  vec2 = vec1;
+  EXPECT_EQ(vec2.size(), 2u);
+  EXPECT_EQ(vec2.template get<int>(0), 30);
+  EXPECT_EQ(vec2.template get<std::string>(1), "assign");
+}
+
+TYPED_TEST(SmallVectorTest, MoveAssignment) {
+  typename TypeParam::template type<int, std::string> vec1;
+  vec1.push_back(40);
+  vec1.push_back(std::string("move_assign"));
+
+  typename TypeParam::template type<int, std::string> vec2;
+  vec2 = std::move(vec1);
+  EXPECT_EQ(vec2.size(), 2u);
+  EXPECT_EQ(vec2.template get<int>(0), 40);
+  EXPECT_EQ(vec2.template get<std::string>(1), "move_assign");
+
+  EXPECT_EQ(vec1.size(), 0u);
+}
+
+TYPED_TEST(SmallVectorTest, ExceptionOnWrongTypeAccess) {
+  typename TypeParam::template type<int, std::string> vec;
+  vec.push_back(50);
+  vec.push_back(std::string("test"));
+
+  EXPECT_NO_THROW((void)vec.template get<int>(0));
+  EXPECT_NO_THROW((void)vec.template get<std::string>(1));
+
+  EXPECT_THROW((void)vec.template get<std::string>(0), std::bad_cast);
+  EXPECT_THROW((void)vec.template get<int>(1), std::bad_cast);
+}
+
+TYPED_TEST(SmallVectorTest, MultiplePushBacks) {
+  typename TypeParam::template type<int, std::string, double> vec;
+  const int num_elements = 100;
+
+  for (int i = 0; i < num_elements; ++i) {
+    if (i % 3 == 0) {
+      vec.push_back(i);
+    } else if (i % 3 == 1) {
+      vec.push_back(std::string("str" + std::to_string(i)));
+    } else {
+      vec.push_back(static_cast<double>(i) * 1.1);
+    }
+  }
+
+  EXPECT_EQ(vec.size(), num_elements);
+
+  for (int i = 0; i < num_elements; ++i) {
+    if (i % 3 == 0) {
+      EXPECT_EQ(vec.template get<int>(i), i);
+    } else if (i % 3 == 1) {
+      EXPECT_EQ(vec.template get<std::string>(i), "str" + std::to_string(i));
+    } else {
+      EXPECT_DOUBLE_EQ(vec.template get<double>(i),
+                       static_cast<double>(i) * 1.1);
+    }
+  }
+}
+
+TYPED_TEST(SmallVectorTest, DestructionOfElements) {
+  Tracker::reset();
+  {
+    typename TypeParam::template type<Tracker> vec;
+    vec.reserve_cap(sizeof(Tracker) * 100);
+    vec.reserve_entries(100);
+    vec.push_back(Tracker());
+    vec.push_back(Tracker());
+    EXPECT_EQ(Tracker::constructions, 2);
+    EXPECT_EQ(Tracker::destructions, 2); // for the temporary
+  }
+  EXPECT_EQ(Tracker::destructions, 4); // the actual elements
+}
+
+TYPED_TEST(SmallVectorTest, ReserveEntries) {
+  typename TypeParam::template type<int, std::string> vec;
+  vec.push_back(1);
+  vec.push_back(2);
+  vec.push_back(3);
+
+  EXPECT_EQ(vec.size(), 3u);
+
+  for (int i = 4; i <= 100; ++i) {
+    vec.push_back(i);
+  }
+
+  EXPECT_EQ(vec.size(), 100u);
+  EXPECT_EQ(vec.template get<int>(99), 100);
+}
+
+TYPED_TEST(SmallVectorTest, HeterogeneousComplexTypes) {
+  struct Complex {
+    std::string name;
+    int value;
+
+    bool operator==(const Complex& other) const {
+      return name == other.name && value == other.value;
+    }
+  };
+
+  typename TypeParam::template type<int, std::string, Complex> vec;
+
+  vec.push_back(7);
+  vec.push_back(std::string("complex"));
+  Complex c1 = {"test", 42};
+  vec.push_back(c1);
+
+  EXPECT_EQ(vec.size(), 3u);
+  EXPECT_EQ(vec.template get<int>(0), 7);
+  EXPECT_EQ(vec.template get<std::string>(1), "complex");
+  EXPECT_EQ(vec.template get<Complex>(2), c1);
+}
+
+TEST(SmallVectorInlineTest, StaysInlineUntilFull) {
+  vv3::small_vector<256, int, double> vec;
+  vec.push_back(1);
+  vec.push_back(2.0);
+  EXPECT_TRUE(vec.is_inline());
+
+  for (int i = 0; i < 200; ++i) {
+    vec.push_back(i);
+  }
+  EXPECT_FALSE(vec.is_inline());
+  EXPECT_EQ(vec.get<int>(0), 1);
+  EXPECT_DOUBLE_EQ(vec.get<double>(1), 2.0);
+  EXPECT_EQ(vec.get<int>(201), 199);
+}
+
+TEST(SmallVectorInlineTest, MoveOfSpilledVectorTakesHeapBlock) {
+  vv3::small_vector<128, int, std::string> vec1;
+  for (int i = 0; i < 50; ++i) {
+    vec1.push_back(std::to_string(i));
+  }
+  ASSERT_FALSE(vec1.is_inline());
+  const std::string* first = &vec1.get<std::string>(0);
+
+  vv3::small_vector<128, int, std::string> vec2 = std::move(vec1);
+  EXPECT_EQ(&vec2.get<std::string>(0), first);
+  EXPECT_EQ(vec2.get<std::string>(49), "49");
+
+  // the moved-from vector falls back to its own inline buffer
+  EXPECT_TRUE(vec1.is_inline());
+  EXPECT_EQ(vec1.size(), 0u);
+  vec1.push_back(7);
+  EXPECT_EQ(vec1.get<int>(0), 7);
+}
+
+TEST(SmallVectorInlineTest, CopyOfSpilledVectorFitsInline) {
+  vv3::small_vector<512, int, std::string> vec1;
+  vec1.reserve_entries(1000);
+  vec1.push_back(std::string("spilled"));
+  ASSERT_FALSE(vec1.is_inline());
+
+  vv3::small_vector<512, int, std::string> vec2 = vec1;
+  EXPECT_TRUE(vec2.is_inline());
+  EXPECT_EQ(vec2.get<std::string>(0), "spilled");
+}
+
+TEST(SmallVectorInlineTest, SlicedMoveIntoHeapVector) {
+  vv3::small_vector<256, int, std::string> small;
+  small.push_back(std::string("inline"));
+  ASSERT_TRUE(small.is_inline());
+
+  vv3::vector<int, std::string> vec = std::move(small);
+  EXPECT_EQ(vec.get<std::string>(0), "inline");
+  EXPECT_EQ(small.size(), 0u);
+}
+
+struct ThrowingMove {
+  ThrowingMove() = default;
+  ThrowingMove(const ThrowingMove&) = default;
+  ThrowingMove(ThrowingMove&&) {}
+};
+
+// only moves that can't allocate or run a throwing element move are noexcept
+TEST(SmallVectorInlineTest, MovesAreNoexceptOnlyWhenTheyCantThrow) {
+  using heap_t = vv3::vector<int, std::string>;
+  using small_t = vv3::small_vector<256, int, std::string>;
+  using throwing_t = vv3::small_vector<256, int, ThrowingMove>;
+  static_assert(std::is_nothrow_move_constructible_v<heap_t>);
+  static_assert(!std::is_nothrow_constructible_v<heap_t, small_t&&>);
+  static_assert(std::is_nothrow_move_constructible_v<small_t>);
+  static_assert(std::is_nothrow_move_assignable_v<small_t>);
+  static_assert(!std::is_nothrow_move_constructible_v<throwing_t>);
+  static_assert(!std::is_nothrow_move_assignable_v<throwing_t>);
+
+  small_t small;
+  small.push_back(1);
+  heap_t vec(std::move(small));
+  EXPECT_EQ(vec.get<int>(0), 1);
+  EXPECT_EQ(small.size(), 0u);
+}
+
+TEST(SmallVectorInlineTest, CompactKeepsInlineAndRepacksSpilled) {
+  vv3::small_vector<256, char, double> vec;
+  vec.push_back('a');
+  vec.push_back(1.0);
+  vec.compact();
+  EXPECT_TRUE(vec.is_inline());
+  EXPECT_DOUBLE_EQ(vec.get<double>(1), 1.0);
+
+  for (int i = 0; i < 100; ++i) {
+    vec.push_back('b');
+    vec.push_back(2.0 * i);
+  }
+  ASSERT_FALSE(vec.is_inline());
+  auto order = vec.compact_by_alignment();
+  EXPECT_FALSE(vec.is_inline());
+  EXPECT_EQ(vec.padding_bytes(), 0u);
+  EXPECT_EQ(order[0], 1u);
+  EXPECT_DOUBLE_EQ(vec.get<double>(0), 1.0);
+  EXPECT_EQ(vec.get<char>(101), 'a');
+
+  // moving out still leaves the inline buffer behind
+  auto moved = std::move(vec);
+  EXPECT_TRUE(vec.is_inline());
+  EXPECT_EQ(moved.size(), 202u);
+}
+
+TEST(SmallVectorInlineTest, ConstantStrideInlineAndSpilled) {
+  vv3::small_vector<128, int, float> vec;
+  EXPECT_EQ(vec.offset_width(), 0u);
+  for (int i = 0; i < 200; ++i) {
+    if (i % 2 == 0) {
+      vec.push_back(i);
+    } else {
+      vec.push_back(static_cast<float>(i));
+    }
+  }
+  EXPECT_EQ(vec.offset_width(), 0u);
+  EXPECT_EQ(vec.get<int>(198), 198);
+  EXPECT_FLOAT_EQ(vec.get<float>(199), 199.0f);
+}
+
+TEST(SmallVectorInlineTest, InsertAndEraseAcrossSpill) {
+  vv3::small_vector<256, char, std::string> vec;
+  for (int i = 0; i < 3; ++i) {
+    vec.push_back(std::to_string(i));
+  }
+  ASSERT_TRUE(vec.is_inline());
+  vec.insert(0, 'a');
+  vec.insert(2, std::string("mid"));
+  for (int i = 0; i < 20; ++i) {
+    vec.insert(1, static_cast<char>('b' + i));
+  }
+  EXPECT_FALSE(vec.is_inline());
+  EXPECT_EQ(vec.size(), 25u);
+  EXPECT_EQ(vec.get<char>(0), 'a');
+  EXPECT_EQ(vec.get<char>(1), 'b' + 19);
+  EXPECT_EQ(vec.get<std::string>(22), "mid");
+
+  vec.erase(1, 21);
+  vec.erase(0);
+  ASSERT_EQ(vec.size(), 4u);
+  EXPECT_EQ(vec.get<std::string>(0), "0");
+  EXPECT_EQ(vec.get<std::string>(1), "mid");
+  EXPECT_EQ(vec.get<std::string>(3), "2");
+}
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
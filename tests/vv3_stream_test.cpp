@@ -0,0 +1,132 @@
+#include "../include/vv3_stream.hpp"
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <string>
+#include <typeinfo>
+
+TEST(StreamVectorTest, DefaultConstructor) {
+  vv3::stream_vector<int, std::string, double> vec;
+  EXPECT_EQ(vec.size(), 0u);
+  EXPECT_EQ(vec.begin(), vec.end());
+}
+
+TEST(StreamVectorTest, PushBackDifferentTypes) {
+  vv3::stream_vector<int, std::string, double> vec;
+
+  vec.push_back(42);
+  vec.push_back(std::string("hello"));
+  vec.push_back(3.14);
+
+  ASSERT_EQ(vec.size(), 3u);
+  EXPECT_EQ(vec.get<int>(0), 42);
+  EXPECT_EQ(vec.get<std::string>(1), "hello");
+  EXPECT_DOUBLE_EQ(vec.get<double>(2), 3.14);
+  EXPECT_THROW((void)vec.get<double>(0), std::bad_cast);
+}
+
+// random access has to walk from a checkpoint, so check indices on both sides
+// of several checkpoint boundaries with mixed alignments
+TEST(StreamVectorTest, RandomAccessAcrossCheckpoints) {
+  vv3::stream_vector<char, std::int16_t, double> vec;
+  constexpr std::size_t n = 5 * decltype(vec)::checkpoint_every + 7;
+
+  for (std::size_t i = 0; i < n; i++) {
+    switch (i % 3) {
+    case 0:
+      vec.push_back(static_cast<char>(i));
+      break;
+    case 1:
+      vec.push_back(static_cast<std::int16_t>(i));
+      break;
+    default:
+      vec.push_back(static_cast<double>(i));
+      break;
+    }
+  }
+
+  ASSERT_EQ(vec.size(), n);
+  for (std::size_t i = 0; i < n; i++) {
+    auto e = vec[i];
+    ASSERT_EQ(e.type_index, i % 3) << i;
+    switch (i % 3) {
+    case 0:
+      EXPECT_EQ(*reinterpret_cast<char*>(e.data), static_cast<char>(i));
+      break;
+    case 1:
+      EXPECT_EQ(reinterpret_cast<std::uintptr_t>(e.data) % 2, 0u);
+      EXPECT_EQ(*reinterpret_cast<std::int16_t*>(e.data),
+                static_cast<std::int16_t>(i));
+      break;
+    default:
+      EXPECT_EQ(reinterpret_cast<std::uintptr_t>(e.data) % alignof(double), 0u);
+      EXPECT_DOUBLE_EQ(*reinterpret_cast<double*>(e.data),
+                       static_cast<double>(i));
+      break;
+    }
+  }
+}
+
+TEST(StreamVectorTest, IteratorAndForEachMatchIndexing) {
+  vv3::stream_vector<int, std::string, double> vec;
+  for (int i = 0; i < 200; i++) {
+    if (i % 2 == 0) {
+      vec.push_back(i);
+    } else {
+      vec.push_back(std::to_string(i));
+    }
+  }
+
+  std::size_t i = 0;
+  for (auto e : vec) {
+    auto expected = vec[i++];
+    EXPECT_EQ(e.type_index, expected.type_index);
+    EXPECT_EQ(e.data, expected.data);
+  }
+  EXPECT_EQ(i, vec.size());
+
+  std::string joined;
+  vec.for_each([&](auto& x) {
+    if constexpr (std::is_same_v<std::decay_t<decltype(x)>, std::string>) {
+      joined += x;
+    }
+  });
+  EXPECT_EQ(joined.substr(0, 4), "1357");
+}
+
+TEST(StreamVectorTest, VisitAndEmplace) {
+  vv3::stream_vector<int, std::string> vec;
+  auto& s = vec.emplace_back<std::string>(3, 'x');
+  EXPECT_EQ(s, "xxx");
+  vec.emplace_back(std::in_place_type<int>, 7);
+
+  std::size_t len = vec.visit(0, [](auto& x) -> std::size_t {
+    if constexpr (std::is_same_v<std::decay_t<decltype(x)>, std::string>) {
+      return x.size();
+    } else {
+      return 0;
+    }
+  });
+  EXPECT_EQ(len, 3u);
+}
+
+TEST(StreamVectorTest, CopyAndMove) {
+  vv3::stream_vector<int, std::string> vec;
+  for (int i = 0; i < 100; i++) {
+    vec.push_back(i);
+    vec.push_back(std::string(40, static_cast<char>('a' + i % 26)));
+  }
+
+  auto copy = vec;
+  ASSERT_EQ(copy.size(), vec.size());
+  EXPECT_EQ(copy.get<int>(98), 49);
+  EXPECT_EQ(copy.get<std::string>(199), std::string(40, 'v'));
+
+  auto moved = std::move(copy);
+  EXPECT_EQ(moved.get<std::string>(1), std::string(40, 'a'));
+  EXPECT_EQ(copy.size(), 0u);
+
+  copy = moved;
+  EXPECT_EQ(copy.get<int>(198), 99);
+  vec = std::move(moved);
+  EXPECT_EQ(vec.size(), 200u);
+}
@@ -1,6 +1,12 @@
 #include "../include/vv3.hpp"
 #include <gtest/gtest.h>
+#include <algorithm>
+#include <cstdint>
+#include <memory_resource>
+#include <ranges>
 #include <string>
+#include <variant>
+#include <vector>
 
 struct Tracker {
   static int constructions;
@@ -20,6 +26,40 @@ struct Tracker {
 int Tracker::constructions = 0;
 int Tracker::destructions = 0;
 
+// std::allocator that counts the blocks it hands out
+template <class T> struct CountingAllocator {
+  using value_type = T;
+
+  std::size_t* live;
+
+  explicit CountingAllocator(std::size_t* l) : live(l) {}
+  template <class U>
+  CountingAllocator(const CountingAllocator<U>& rhs) : live(rhs.live) {}
+
+  T* allocate(std::size_t n) {
+    ++*live;
+    return std::allocator<T>().allocate(n);
+  }
+  void deallocate(T* p, std::size_t n) {
+    --*live;
+    std::allocator<T>().deallocate(p, n);
+  }
+
+  template <class U> bool operator==(const CountingAllocator<U>& rhs) const {
+    return live == rhs.live;
+  }
+};
+
+// counts every constructor, including moves, so relocation leaks show up
+struct Counted {
+  static inline int live = 0;
+
+  Counted() { ++live; }
+  Counted(const Counted&) { ++live; }
+  Counted(Counted&&) noexcept { ++live; }
+  ~Counted() { --live; }
+};
+
 using vv3::Element;
 using vv3::vector;
 
@@ -204,6 +244,853 @@ TEST(VectorTest, HeterogeneousComplexTypes) {
   EXPECT_EQ(vec.get<Complex>(2), c1);
 }
 
+TEST(VectorTest, MixedAlignmentAfterGrowth) {
+  vector<char, double, std::string> vec;
+  for (int i = 0; i < 50; ++i) {
+    vec.push_back('c');
+    vec.push_back(static_cast<double>(i));
+    vec.push_back(std::to_string(i));
+  }
+
+  for (std::size_t i = 0; i < vec.size(); ++i) {
+    auto addr = reinterpret_cast<std::uintptr_t>(vec[i].data);
+    if (vec[i].type_index == 1) {
+      EXPECT_EQ(addr % alignof(double), 0u);
+    } else if (vec[i].type_index == 2) {
+      EXPECT_EQ(addr % alignof(std::string), 0u);
+    }
+  }
+  EXPECT_EQ(vec.get<char>(0), 'c');
+  EXPECT_DOUBLE_EQ(vec.get<double>(148), 49.0);
+  EXPECT_EQ(vec.get<std::string>(149), "49");
+}
+
+TEST(VectorTest, OffsetWidthGrowsWithCapacity) {
+  vector<int, std::string> vec;
+  EXPECT_EQ(vec.offset_width(), 1u);
+
+  vec.reserve_cap(200);
+  EXPECT_EQ(vec.offset_width(), 1u);
+
+  for (int i = 0; i < 40; ++i) {
+    vec.push_back(i);
+  }
+  EXPECT_EQ(vec.offset_width(), 1u);
+
+  vec.reserve_cap(1000);
+  EXPECT_EQ(vec.offset_width(), 2u);
+
+  vec.reserve_cap(std::size_t{1} << 17);
+  EXPECT_EQ(vec.offset_width(), 4u);
+
+  // widening must preserve every existing offset
+  for (int i = 0; i < 40; ++i) {
+    EXPECT_EQ(vec.get<int>(i), i);
+  }
+}
+
+TEST(VectorTest, OffsetsSurviveWideningDuringPushBack) {
+  vector<char, std::string> vec;
+  for (int i = 0; i < 2000; ++i) {
+    if (i % 2 == 0) {
+      vec.push_back(static_cast<char>('a' + i % 26));
+    } else {
+      vec.push_back(std::to_string(i));
+    }
+  }
+  EXPECT_GE(vec.offset_width(), 2u);
+
+  for (int i = 0; i < 2000; ++i) {
+    if (i % 2 == 0) {
+      EXPECT_EQ(vec.get<char>(i), static_cast<char>('a' + i % 26));
+    } else {
+      EXPECT_EQ(vec.get<std::string>(i), std::to_string(i));
+    }
+  }
+}
+
+TEST(VectorTest, TagTypeIsNarrowest) {
+  static_assert(std::is_same_v<vector<int, double>::tag_type, std::uint8_t>);
+  static_assert(std::is_same_v<vv3::tag_for_t<255>, std::uint8_t>);
+  static_assert(std::is_same_v<vv3::tag_for_t<256>, std::uint16_t>);
+  static_assert(std::is_same_v<vv3::tag_for_t<70000>, std::uint32_t>);
+
+  vector<int, double> vec;
+  vec.push_back(1.5);
+  auto e = vec[0];
+  static_assert(std::is_same_v<decltype(e.type_index), std::uint8_t>);
+  EXPECT_EQ(e.type_index, 1u);
+}
+
+struct Relocatable {
+  int* p;
+
+  explicit Relocatable(int v) : p(new int(v)) {}
+  Relocatable(const Relocatable& rhs) : p(new int(*rhs.p)) {}
+  Relocatable(Relocatable&& rhs) noexcept : p(rhs.p) { rhs.p = nullptr; }
+  ~Relocatable() { delete p; }
+};
+
+template <> struct vv3::is_trivially_relocatable<Relocatable> : std::true_type {};
+
+TEST(VectorTest, TriviallyCopyableCopyAndGrowth) {
+  vector<char, int, double> vec;
+  for (int i = 0; i < 500; ++i) {
+    if (i % 3 == 0) {
+      vec.push_back(static_cast<char>(i % 100));
+    } else if (i % 3 == 1) {
+      vec.push_back(i);
+    } else {
+      vec.push_back(i * 0.25);
+    }
+  }
+
+  vector<char, int, double> copy = vec;
+  vector<char, int, double> assigned;
+  assigned.push_back(1);
+  assigned = vec;
+
+  for (int i = 0; i < 500; ++i) {
+    if (i % 3 == 0) {
+      EXPECT_EQ(copy.get<char>(i), static_cast<char>(i % 100));
+      EXPECT_EQ(assigned.get<char>(i), static_cast<char>(i % 100));
+    } else if (i % 3 == 1) {
+      EXPECT_EQ(copy.get<int>(i), i);
+      EXPECT_EQ(assigned.get<int>(i), i);
+    } else {
+      EXPECT_DOUBLE_EQ(copy.get<double>(i), i * 0.25);
+      EXPECT_DOUBLE_EQ(assigned.get<double>(i), i * 0.25);
+    }
+  }
+}
+
+TEST(VectorTest, RelocatableSpecializationMovesWithMemcpy) {
+  vector<int, Relocatable> vec;
+  for (int i = 0; i < 200; ++i) {
+    vec.push_back(Relocatable(i));
+  }
+  for (int i = 0; i < 200; ++i) {
+    EXPECT_EQ(*vec.get<Relocatable>(i).p, i);
+  }
+
+  // not trivially copyable, so copies still go through the copy constructor
+  vector<int, Relocatable> copy = vec;
+  EXPECT_NE(copy.get<Relocatable>(0).p, vec.get<Relocatable>(0).p);
+  EXPECT_EQ(*copy.get<Relocatable>(199).p, 199);
+}
+
+TEST(VectorTest, RelocationDestroysMovedFromElements) {
+  {
+    vector<int, Counted> vec;
+    for (int i = 0; i < 100; ++i) {
+      vec.push_back(i);
+      vec.push_back(Counted());
+    }
+    EXPECT_EQ(Counted::live, 100);
+  }
+  EXPECT_EQ(Counted::live, 0);
+}
+
+TEST(VectorTest, EmplaceBackConstructsInPlace) {
+  struct Record {
+    std::string name;
+    int value;
+
+    Record(std::string n, int v) : name(std::move(n)), value(v) {}
+    // capacity is reserved up front, so neither should ever run
+    Record(const Record&) { ADD_FAILURE() << "copied"; }
+    Record(Record&&) noexcept { ADD_FAILURE() << "moved"; }
+  };
+
+  vector<int, Record> vec;
+  vec.reserve_cap(sizeof(Record) * 8);
+  vec.reserve_entries(8);
+
+  Record& r = vec.emplace_back<Record>("first", 1);
+  EXPECT_EQ(&r, &vec.get<Record>(0));
+  vec.emplace_back(std::in_place_type<Record>, "second", 2);
+  vec.emplace_back<int>(3);
+
+  EXPECT_EQ(vec.size(), 3u);
+  EXPECT_EQ(vec.get<Record>(0).name, "first");
+  EXPECT_EQ(vec.get<Record>(1).value, 2);
+  EXPECT_EQ(vec.get<int>(2), 3);
+}
+
+TEST(VectorTest, CustomAllocator) {
+  std::size_t live = 0;
+  using Alloc = CountingAllocator<std::byte>;
+  {
+    vv3::basic_vector<Alloc, int, std::string> vec{Alloc(&live)};
+    for (int i = 0; i < 50; ++i) {
+      vec.push_back(i);
+      vec.push_back(std::to_string(i));
+    }
+    // header, tags, offsets and payload share one block
+    EXPECT_EQ(live, 1u);
+
+    auto copy = vec;
+    EXPECT_EQ(live, 2u);
+    EXPECT_EQ(copy.get<std::string>(99), "49");
+  }
+  EXPECT_EQ(live, 0u);
+}
+
+TEST(VectorTest, PmrMonotonicResource) {
+  std::byte buffer[16384];
+  std::pmr::monotonic_buffer_resource resource(buffer, sizeof(buffer),
+                                               std::pmr::null_memory_resource());
+  vv3::pmr::vector<char, double, long long> vec(&resource);
+  for (int i = 0; i < 30; ++i) {
+    vec.push_back(static_cast<char>('a' + i % 26));
+    vec.push_back(i * 0.5);
+    vec.push_back(static_cast<long long>(i));
+  }
+  EXPECT_EQ(vec.get_allocator().resource(), &resource);
+
+  for (int i = 0; i < 30; ++i) {
+    EXPECT_EQ(vec.get<char>(3 * i), static_cast<char>('a' + i % 26));
+    EXPECT_DOUBLE_EQ(vec.get<double>(3 * i + 1), i * 0.5);
+    EXPECT_EQ(vec.get<long long>(3 * i + 2), i);
+    auto addr = reinterpret_cast<std::uintptr_t>(vec[3 * i + 1].data);
+    EXPECT_EQ(addr % alignof(double), 0u);
+  }
+}
+
+TEST(VectorTest, PmrMoveAssignAcrossResources) {
+  std::pmr::monotonic_buffer_resource r1;
+  std::pmr::monotonic_buffer_resource r2;
+  vv3::pmr::vector<int, std::string> a(&r1);
+  vv3::pmr::vector<int, std::string> b(&r2);
+  a.push_back(1);
+  a.push_back(std::string("a string too long for small buffer optimization"));
+
+  b = std::move(a);
+  EXPECT_EQ(b.get_allocator().resource(), &r2);
+  EXPECT_EQ(b.size(), 2u);
+  EXPECT_EQ(b.get<int>(0), 1);
+  EXPECT_EQ(b.get<std::string>(1),
+            "a string too long for small buffer optimization");
+}
+
+TEST(VectorTest, SingleBlockLayout) {
+  static_assert(sizeof(vector<int, std::string>) == sizeof(void*));
+
+  vector<char, double, std::string> vec;
+  vec.push_back('a');
+  vec.reserve_entries(64);
+  vec.push_back(2.5);
+  vec.reserve_cap(4096);
+  vec.push_back(std::string("kept across regrowth"));
+  vec.reserve_entries(1000);
+
+  EXPECT_EQ(vec.size(), 3u);
+  EXPECT_EQ(vec.get<char>(0), 'a');
+  EXPECT_DOUBLE_EQ(vec.get<double>(1), 2.5);
+  EXPECT_EQ(vec.get<std::string>(2), "kept across regrowth");
+  EXPECT_EQ(vec.offset_width(), 2u);
+}
+
+TEST(VectorTest, VisitCallsWithTypedReference) {
+  vector<int, double, std::string> vec;
+  vec.push_back(7);
+  vec.push_back(2.5);
+  vec.push_back(std::string("seven"));
+
+  auto describe = [](auto& x) -> std::string {
+    using T = std::decay_t<decltype(x)>;
+    if constexpr (std::is_same_v<T, int>) {
+      return "int " + std::to_string(x);
+    } else if constexpr (std::is_same_v<T, double>) {
+      return "double";
+    } else {
+      return "string " + x;
+    }
+  };
+  EXPECT_EQ(vec.visit(0, describe), "int 7");
+  EXPECT_EQ(vec.visit(1, describe), "double");
+  EXPECT_EQ(vec.visit(2, describe), "string seven");
+
+  // references are to the stored element
+  vec.visit(0, [](auto& x) {
+    if constexpr (std::is_same_v<std::decay_t<decltype(x)>, int>) {
+      x = 8;
+    }
+  });
+  EXPECT_EQ(vec.get<int>(0), 8);
+}
+
+TEST(VectorTest, ForEachVisitsInOrder) {
+  vector<int, std::string> vec;
+  for (int i = 0; i < 20; ++i) {
+    if (i % 2 == 0) {
+      vec.push_back(i);
+    } else {
+      vec.push_back(std::to_string(i));
+    }
+  }
+
+  std::string joined;
+  int sum = 0;
+  struct Visitor {
+    std::string& joined;
+    int& sum;
+    void operator()(int x) { sum += x; }
+    void operator()(const std::string& s) { joined += s; }
+  };
+  vec.for_each(Visitor{joined, sum});
+
+  EXPECT_EQ(sum, 0 + 2 + 4 + 6 + 8 + 10 + 12 + 14 + 16 + 18);
+  EXPECT_EQ(joined, "135791113151719");
+}
+
+TEST(VectorTest, IteratorWalksPayloadInOrder) {
+  static_assert(std::ranges::forward_range<vector<int, double>>);
+
+  vector<char, double, std::string> vec;
+  for (auto e : vec) {
+    (void)e;
+    ADD_FAILURE() << "empty vector yielded an element";
+  }
+
+  for (int i = 0; i < 60; ++i) {
+    vec.push_back(static_cast<char>('a' + i % 26));
+    vec.push_back(i * 1.5);
+    vec.push_back(std::to_string(i));
+  }
+
+  std::size_t i = 0;
+  for (auto e : vec) {
+    auto expected = vec[i];
+    EXPECT_EQ(e.type_index, expected.type_index);
+    EXPECT_EQ(e.data, expected.data);
+    ++i;
+  }
+  EXPECT_EQ(i, vec.size());
+  EXPECT_EQ(std::ranges::distance(vec), 180);
+
+  auto doubles = std::ranges::count_if(
+      vec, [](auto e) { return e.type_index == 1; });
+  EXPECT_EQ(doubles, 60);
+}
+
+// lengths around the vector width so both the simd body and the scalar tail
+// are exercised, checked against indexing
+TEST(VectorTest, TagScansMatchIndexing) {
+  for (std::size_t n : {0u, 1u, 15u, 16u, 31u, 33u, 64u, 100u, 257u}) {
+    vv3::vector<char, int, double> vec;
+    for (std::size_t i = 0; i < n; ++i) {
+      if (i % 7 == 3) {
+        vec.push_back(static_cast<int>(i));
+      } else if (i % 2) {
+        vec.push_back(static_cast<double>(i));
+      } else {
+        vec.push_back(static_cast<char>(i));
+      }
+    }
+
+    std::size_t ints = 0;
+    std::size_t first_int = n;
+    std::vector<std::uint64_t> mask((n + 63) / 64);
+    for (std::size_t i = 0; i < n; ++i) {
+      if (vec[i].type_index == 1) {
+        ++ints;
+        first_int = std::min(first_int, i);
+        mask[i / 64] |= std::uint64_t{1} << (i % 64);
+      }
+    }
+
+    EXPECT_EQ(vec.count_type<int>(), ints) << n;
+    EXPECT_EQ(vec.find_type<int>(), first_int) << n;
+    EXPECT_EQ(vec.type_mask<int>(), mask) << n;
+    EXPECT_EQ(vec.count_type<char>() + vec.count_type<double>() + ints, n);
+
+    for (std::size_t from = 0; from < n; from += 5) {
+      std::size_t expected = from;
+      while (expected < n && vec[expected].type_index != 1) {
+        ++expected;
+      }
+      EXPECT_EQ(vec.find_type<int>(from), expected) << n << " " << from;
+    }
+    EXPECT_EQ(vec.find_type<int>(n), n);
+  }
+}
+
+TEST(VectorTest, TagScansOnWideTags) {
+  std::uint16_t tags[]{3, 300, 3, 7, 300};
+  EXPECT_EQ(vv3::detail::count_tags<std::uint16_t>(tags, 0, 5, 300), 2u);
+  EXPECT_EQ(vv3::detail::find_tag<std::uint16_t>(tags, 2, 5, 300), 4u);
+  std::uint64_t mask = 0;
+  vv3::detail::mask_tags<std::uint16_t>(tags, 5, 3, &mask);
+  EXPECT_EQ(mask, 0b101u);
+}
+
+TEST(VectorTest, PaddingAccounting) {
+  vv3::vector<char, double> vec;
+  EXPECT_EQ(vec.payload_bytes(), 0u);
+  EXPECT_EQ(vec.padding_bytes(), 0u);
+  EXPECT_EQ(vec.metadata_bytes(), 0u);
+
+  for (int i = 0; i < 4; ++i) {
+    vec.push_back('c');
+    vec.push_back(1.0 * i);
+  }
+  // c _______ d c _______ d ...
+  EXPECT_EQ(vec.payload_bytes(), 4 * (1u + 8u));
+  EXPECT_EQ(vec.padding_bytes(), 4 * 7u);
+  EXPECT_GE(vec.metadata_bytes(), vec.size() * (1 + vec.offset_width()));
+}
+
+TEST(VectorTest, CompactShrinksToContents) {
+  vv3::vector<int, std::string> vec;
+  vec.reserve_entries(1000);
+  vec.reserve_cap(1 << 20);
+  vec.push_back(1);
+  vec.push_back(std::string(64, 's'));
+  vec.push_back(3);
+  std::size_t before = vec.metadata_bytes();
+  EXPECT_EQ(vec.offset_width(), 4u);
+
+  vec.compact();
+  EXPECT_LT(vec.metadata_bytes(), before);
+  EXPECT_EQ(vec.offset_width(), 1u);
+  ASSERT_EQ(vec.size(), 3u);
+  EXPECT_EQ(vec.get<int>(0), 1);
+  EXPECT_EQ(vec.get<std::string>(1), std::string(64, 's'));
+  EXPECT_EQ(vec.get<int>(2), 3);
+
+  // still appends normally afterwards
+  vec.push_back(std::string("more"));
+  EXPECT_EQ(vec.get<std::string>(3), "more");
+
+  vv3::vector<int> empty;
+  empty.reserve_cap(256);
+  empty.compact();
+  EXPECT_EQ(empty.metadata_bytes(), 0u);
+}
+
+TEST(VectorTest, CompactRepacksTightly) {
+  vv3::vector<char, short, double, std::string> vec;
+  vv3::vector<char, short, double, std::string> fresh;
+  for (int i = 0; i < 21; ++i) {
+    switch (i % 4) {
+    case 0:
+      vec.push_back(static_cast<char>('a' + i));
+      break;
+    case 1:
+      vec.push_back(1.5 * i);
+      break;
+    case 2:
+      vec.push_back(static_cast<short>(i));
+      break;
+    default:
+      vec.push_back(std::to_string(i));
+    }
+  }
+  vec.erase(5, 7);
+  vec.compact();
+
+  for (std::size_t i = 0; i < vec.size(); ++i) {
+    vec.visit(i, [&](auto& x) { fresh.push_back(x); });
+  }
+  EXPECT_EQ(vec.padding_bytes(), fresh.padding_bytes());
+  ASSERT_EQ(vec.size(), 19u);
+  for (std::size_t i = 0; i < vec.size(); ++i) {
+    EXPECT_EQ(vec[i].data - vec[0].data, fresh[i].data - fresh[0].data);
+  }
+  EXPECT_EQ(vec.get<std::string>(17), "19");
+}
+
+TEST(VectorTest, CompactByAlignmentRemovesPadding) {
+  vv3::vector<char, double, std::string> vec;
+  for (int i = 0; i < 10; ++i) {
+    vec.push_back(static_cast<char>('a' + i));
+    vec.push_back(1.5 * i);
+    if (i % 3 == 0) {
+      vec.push_back(std::to_string(i));
+    }
+  }
+  EXPECT_GT(vec.padding_bytes(), 0u);
+  std::size_t payload = vec.payload_bytes();
+
+  auto before = vec;
+  auto order = vec.compact_by_alignment();
+  EXPECT_EQ(vec.padding_bytes(), 0u);
+  EXPECT_EQ(vec.payload_bytes(), payload);
+  ASSERT_EQ(order.size(), before.size());
+
+  for (std::size_t i = 0; i < vec.size(); ++i) {
+    auto e = vec[i];
+    auto old = before[order[i]];
+    ASSERT_EQ(e.type_index, old.type_index);
+    if (i > 0) {
+      // stable: same alignment class keeps its relative order
+      auto prev = vec[i - 1];
+      if (prev.type_index == e.type_index) {
+        EXPECT_LT(order[i - 1], order[i]);
+      }
+    }
+    switch (e.type_index) {
+    case 0:
+      EXPECT_EQ(vec.get<char>(i), before.get<char>(order[i]));
+      break;
+    case 1:
+      EXPECT_EQ(vec.get<double>(i), before.get<double>(order[i]));
+      break;
+    default:
+      EXPECT_EQ(vec.get<std::string>(i), before.get<std::string>(order[i]));
+      break;
+    }
+  }
+
+  std::size_t n = 0;
+  for (auto e : vec) {
+    EXPECT_EQ(e.data, vec[n++].data);
+  }
+  EXPECT_EQ(n, vec.size());
+}
+
+TEST(VectorTest, ReserveBothRegionsAtOnce) {
+  vv3::vector<char, double, std::string> vec;
+  vec.reserve(10, 100);
+  std::size_t meta = vec.metadata_bytes();
+  EXPECT_GE(meta, 10 * (1 + vec.offset_width()));
+
+  // smaller requests never shrink
+  vec.reserve(1, 1);
+  EXPECT_EQ(vec.metadata_bytes(), meta);
+}
+
+TEST(VectorTest, ReserveForCoversWorstCaseOrder) {
+  using vec_t = vv3::vector<char, double, std::string>;
+  static_assert(vec_t::worst_case_bytes<char, double>(1, 1) == 1 + 15);
+  static_assert(vec_t::worst_case_bytes<>() == 0);
+
+  vec_t vec;
+  vec.reserve_for<char, double, std::string>(50, 50, 5);
+  // char/double alternation is the worst case for padding
+  vec.push_back(std::string("first"));
+  const std::string* first = &vec.get<std::string>(0);
+  for (int i = 0; i < 50; ++i) {
+    vec.push_back('c');
+    vec.push_back(1.0 * i);
+  }
+  for (int i = 0; i < 4; ++i) {
+    vec.push_back(std::string("more"));
+  }
+  // no regrowth, so nothing moved
+  EXPECT_EQ(&vec.get<std::string>(0), first);
+  EXPECT_EQ(vec.size(), 105u);
+}
+
+TEST(VectorTest, ShrinkToFitTrimsBothRegions) {
+  vv3::vector<int, std::string> vec;
+  vec.reserve(4096, 1 << 17);
+  for (int i = 0; i < 10; ++i) {
+    vec.push_back(i);
+    vec.push_back(std::to_string(i));
+  }
+  std::size_t before = vec.metadata_bytes();
+  EXPECT_EQ(vec.offset_width(), 4u);
+
+  vec.shrink_to_fit();
+  EXPECT_LT(vec.metadata_bytes(), before / 10);
+  EXPECT_LT(vec.offset_width(), 4u);
+  EXPECT_EQ(vec.get<int>(18), 9);
+  EXPECT_EQ(vec.get<std::string>(19), "9");
+
+  vec.push_back(10);
+  EXPECT_EQ(vec.get<int>(20), 10);
+}
+
+TEST(VectorTest, ConstantStrideStoresNoOffsets) {
+  vv3::vector<int, float, std::uint32_t> vec;
+  EXPECT_EQ(vec.offset_width(), 0u);
+  for (int i = 0; i < 1000; ++i) {
+    switch (i % 3) {
+    case 0:
+      vec.push_back(i);
+      break;
+    case 1:
+      vec.push_back(static_cast<float>(i));
+      break;
+    default:
+      vec.push_back(static_cast<std::uint32_t>(i));
+      break;
+    }
+  }
+
+  EXPECT_EQ(vec.offset_width(), 0u);
+  EXPECT_EQ(vec.padding_bytes(), 0u);
+  // just the header and a tag per entry
+  EXPECT_LT(vec.metadata_bytes(), 2 * vec.size());
+  for (std::size_t i = 0; i < vec.size(); ++i) {
+    EXPECT_EQ(vec[i].data - vec[0].data,
+              static_cast<std::ptrdiff_t>(i * sizeof(int)));
+  }
+  EXPECT_EQ(vec.get<int>(999), 999);
+  EXPECT_FLOAT_EQ(vec.get<float>(997), 997.0f);
+  EXPECT_EQ(vec.get<std::uint32_t>(998), 998u);
+  EXPECT_THROW((void)vec.get<float>(999), std::bad_cast);
+
+  auto copy = vec;
+  copy.shrink_to_fit();
+  EXPECT_EQ(copy.get<int>(999), 999);
+  auto order = copy.compact_by_alignment();
+  EXPECT_TRUE(std::ranges::is_sorted(order));
+
+  std::size_t i = 0;
+  for (auto e : vec) {
+    EXPECT_EQ(e.data, vec[i++].data);
+  }
+}
+
+TEST(VectorTest, PopBackAndClearKeepTheBlock) {
+  Counted::live = 0;
+  {
+    vv3::vector<int, std::string, Counted> vec;
+    for (int i = 0; i < 10; ++i) {
+      vec.push_back(i);
+      vec.push_back(Counted());
+      vec.push_back(std::to_string(i));
+    }
+    EXPECT_EQ(Counted::live, 10);
+
+    vec.pop_back();
+    vec.pop_back();
+    EXPECT_EQ(vec.size(), 28u);
+    EXPECT_EQ(Counted::live, 9);
+    EXPECT_EQ(vec.get<int>(27), 9);
+
+    std::size_t meta = vec.metadata_bytes();
+    vec.clear();
+    EXPECT_EQ(vec.size(), 0u);
+    EXPECT_EQ(Counted::live, 0);
+    EXPECT_EQ(vec.metadata_bytes(), meta);
+
+    vec.push_back(std::string("again"));
+    EXPECT_EQ(vec.get<std::string>(0), "again");
+  }
+  EXPECT_EQ(Counted::live, 0);
+}
+
+// random inserts and erases checked against a vector of variants
+TEST(VectorTest, EraseAndInsertMatchReference) {
+  using ref_t = std::variant<char, int, double, std::string>;
+  vv3::vector<char, int, double, std::string> vec;
+  std::vector<ref_t> ref;
+
+  auto make = [](std::size_t k) -> ref_t {
+    switch (k % 4) {
+    case 0:
+      return static_cast<char>('a' + k % 26);
+    case 1:
+      return static_cast<int>(k);
+    case 2:
+      return k * 0.5;
+    default:
+      return std::string(k % 40, 's');
+    }
+  };
+  auto check = [&] {
+    ASSERT_EQ(vec.size(), ref.size());
+    for (std::size_t i = 0; i < ref.size(); ++i) {
+      auto e = vec[i];
+      ASSERT_EQ(e.type_index, ref[i].index());
+      std::visit(
+          [&](auto& x) {
+            using T = std::decay_t<decltype(x)>;
+            EXPECT_EQ(reinterpret_cast<std::uintptr_t>(e.data) % alignof(T),
+                      0u);
+            EXPECT_EQ(vec.get<T>(i), x);
+          },
+          ref[i]);
+    }
+  };
+
+  std::uint64_t seed = 42;
+  auto next = [&] {
+    seed = seed * 6364136223846793005ull + 1442695040888963407ull;
+    return static_cast<std::size_t>(seed >> 33);
+  };
+  for (std::size_t step = 0; step < 600; ++step) {
+    std::size_t r = next();
+    if (ref.empty() || r % 5 < 2) {
+      std::size_t at = ref.empty() ? 0 : next() % (ref.size() + 1);
+      ref_t value = make(r);
+      std::visit([&](auto& x) { vec.insert(at, x); }, value);
+      ref.insert(ref.begin() + static_cast<std::ptrdiff_t>(at), value);
+    } else if (r % 5 == 2) {
+      std::size_t first = next() % ref.size();
+      std::size_t last = first + next() % std::min<std::size_t>(
+                                             4, ref.size() - first + 1);
+      vec.erase(first, last);
+      ref.erase(ref.begin() + static_cast<std::ptrdiff_t>(first),
+                ref.begin() + static_cast<std::ptrdiff_t>(last));
+    } else if (r % 5 == 3) {
+      std::size_t at = next() % ref.size();
+      vec.erase(at);
+      ref.erase(ref.begin() + static_cast<std::ptrdiff_t>(at));
+    } else {
+      vec.pop_back();
+      ref.pop_back();
+    }
+    if (step % 50 == 0) {
+      check();
+    }
+  }
+  check();
+}
+
+// the iterator derives addresses from the tags alone, so it only agrees with
+// operator[] if erase and insert leave the payload tightly packed
+TEST(VectorTest, IteratorAgreesAfterEraseAndInsert) {
+  using vec_t = vv3::vector<char, short, double, std::string>;
+  auto check = [](vec_t& vec) {
+    std::size_t i = 0;
+    for (auto e : vec) {
+      ASSERT_LT(i, vec.size());
+      EXPECT_EQ(e.type_index, vec[i].type_index);
+      EXPECT_EQ(e.data, vec[i].data) << "element " << i;
+      ++i;
+    }
+    EXPECT_EQ(i, vec.size());
+  };
+
+  vec_t vec;
+  vec.push_back('a');
+  vec.push_back(1.5);
+  vec.push_back(short{7});
+  vec.erase(1);
+  check(vec);
+  EXPECT_EQ(vec.get<short>(1), 7);
+
+  vec_t ins;
+  ins.push_back('a');
+  ins.push_back(short{7});
+  ins.push_back(2.5);
+  ins.insert(1, 4.0);
+  check(ins);
+  EXPECT_DOUBLE_EQ(ins.get<double>(3), 2.5);
+
+  std::uint64_t seed = 7;
+  auto next = [&] {
+    seed = seed * 6364136223846793005ull + 1442695040888963407ull;
+    return static_cast<std::size_t>(seed >> 33);
+  };
+  vec.clear();
+  for (std::size_t step = 0; step < 400; ++step) {
+    std::size_t r = next();
+    std::size_t at = vec.size() == 0 ? 0 : next() % (vec.size() + 1);
+    if (vec.size() == 0 || r % 3 != 0) {
+      switch (r % 4) {
+      case 0:
+        vec.insert(at, static_cast<char>('a' + r % 26));
+        break;
+      case 1:
+        vec.insert(at, static_cast<short>(r));
+        break;
+      case 2:
+        vec.insert(at, r * 0.5);
+        break;
+      default:
+        vec.insert(at, std::to_string(r));
+      }
+    } else {
+      std::size_t first = at == vec.size() ? at - 1 : at;
+      vec.erase(first, std::min(vec.size(), first + 1 + next() % 3));
+    }
+    check(vec);
+  }
+
+  // and nothing is left for compact() to squeeze out
+  std::size_t padding = vec.padding_bytes();
+  vec.compact();
+  EXPECT_EQ(vec.padding_bytes(), padding);
+}
+
+TEST(VectorTest, EraseMaskPacksSurvivors) {
+  Counted::live = 0;
+  {
+    vv3::vector<char, double, Counted> vec;
+    for (int i = 0; i < 100; ++i) {
+      vec.push_back(static_cast<char>(i));
+      vec.push_back(Counted());
+      vec.push_back(static_cast<double>(i));
+    }
+    EXPECT_EQ(vec.erase_mask(vec.type_mask<Counted>()), 100u);
+    EXPECT_EQ(Counted::live, 0);
+    ASSERT_EQ(vec.size(), 200u);
+    EXPECT_EQ(vec.count_type<Counted>(), 0u);
+    for (int i = 0; i < 100; ++i) {
+      EXPECT_EQ(vec.get<char>(2 * i), static_cast<char>(i));
+      EXPECT_DOUBLE_EQ(vec.get<double>(2 * i + 1), i);
+    }
+    EXPECT_EQ(vec.padding_bytes(), 100 * (alignof(double) - 1));
+
+    EXPECT_EQ(vec.erase_mask(vec.type_mask<char>()), 100u);
+    EXPECT_EQ(vec.padding_bytes(), 0u);
+    EXPECT_DOUBLE_EQ(vec.get<double>(99), 99.0);
+  }
+}
+
+TEST(VectorTest, EraseAndInsertWithConstantStride) {
+  vv3::vector<int, float> vec;
+  for (int i = 0; i < 20; ++i) {
+    vec.push_back(i);
+  }
+  vec.erase(0, 5);
+  vec.insert(3, 1.5f);
+  vec.erase(10);
+  vec.insert(0, -1);
+
+  std::vector<int> ints;
+  for (std::size_t i = 0; i < vec.size(); ++i) {
+    if (vec[i].type_index == 0) {
+      ints.push_back(vec.get<int>(i));
+    }
+    EXPECT_EQ(vec[i].data - vec[0].data,
+              static_cast<std::ptrdiff_t>(4 * i));
+  }
+  EXPECT_EQ(ints, (std::vector<int>{-1, 5, 6, 7, 8, 9, 10, 11, 12, 13, 15, 16,
+                                    17, 18, 19}));
+  EXPECT_FLOAT_EQ(vec.get<float>(4), 1.5f);
+}
+
+// a sliding window settles into one block
+TEST(VectorTest, SlidingWindowStopsAllocating) {
+  std::size_t live = 0;
+  vv3::basic_vector<CountingAllocator<std::byte>, char, double, std::string>
+      vec{CountingAllocator<std::byte>(&live)};
+  std::size_t k = 0;
+  auto slide = [&] {
+    for (int i = 0; i < 8; ++i, ++k) {
+      if (k % 3 == 0) {
+        vec.push_back(static_cast<char>(k));
+      } else if (k % 3 == 1) {
+        vec.push_back(static_cast<double>(k));
+      } else {
+        vec.push_back(std::to_string(k));
+      }
+    }
+    if (vec.size() > 64) {
+      vec.erase(0, 8);
+    }
+  };
+  for (int w = 0; w < 20; ++w) {
+    slide();
+  }
+  auto* block = vec[0].data - vec.metadata_bytes();
+  for (int w = 0; w < 200; ++w) {
+    slide();
+  }
+  EXPECT_EQ(vec[0].data - vec.metadata_bytes(), block);
+  EXPECT_EQ(live, 1u);
+  EXPECT_EQ(vec.size(), 64u);
+  // the newest string was pushed k % 3 elements before the end
+  EXPECT_EQ(vec.get<std::string>(63 - k % 3), std::to_string(k - 1 - k % 3));
+}
+
 int main(int argc, char** argv) {
   ::testing::InitGoogleTest(&argc, argv);
   return RUN_ALL_TESTS();
@@ -0,0 +1,137 @@
+#include "../include/vv3_tombstone.hpp"
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+using tomb_t = vv3::tombstone_vector<char, int, std::string>;
+
+TEST(TombstoneVectorTest, ErasedElementsDisappearBeforeCompaction) {
+  tomb_t vec(0.9);
+  for (int i = 0; i < 200; i++) {
+    vec.push_back(i);
+  }
+  vec.erase(0, 10);
+  vec.erase(5);
+  vec.erase(100, 103);
+  EXPECT_EQ(vec.tombstones(), 14u);
+  ASSERT_EQ(vec.size(), 186u);
+
+  std::vector<int> expected;
+  for (int i = 10; i < 200; i++) {
+    if (i != 15 && (i < 111 || i > 113)) {
+      expected.push_back(i);
+    }
+  }
+  for (std::size_t i = 0; i < vec.size(); i++) {
+    EXPECT_EQ(vec.get<int>(i), expected[i]);
+    EXPECT_EQ(static_cast<void*>(vec[i].data), &vec.get<int>(i));
+  }
+
+  std::vector<int> visited;
+  vec.for_each([&](auto& x) {
+    if constexpr (std::is_same_v<std::decay_t<decltype(x)>, int>) {
+      visited.push_back(x);
+    }
+  });
+  EXPECT_EQ(visited, expected);
+
+  vec.compact();
+  EXPECT_EQ(vec.tombstones(), 0u);
+  ASSERT_EQ(vec.size(), expected.size());
+  for (std::size_t i = 0; i < vec.size(); i++) {
+    EXPECT_EQ(vec.get<int>(i), expected[i]);
+  }
+}
+
+// whole words of tombstones in front of and between live elements
+TEST(TombstoneVectorTest, IndexingMatchesReference) {
+  tomb_t vec(0.99);
+  std::vector<int> ref;
+  for (int i = 0; i < 1000; i++) {
+    vec.push_back(i);
+    ref.push_back(i);
+  }
+  std::uint64_t seed = 3;
+  auto next = [&] {
+    seed = seed * 6364136223846793005ull + 1442695040888963407ull;
+    return static_cast<std::size_t>(seed >> 33);
+  };
+  vec.erase(0, 200);
+  ref.erase(ref.begin(), ref.begin() + 200);
+  vec.erase(300, 450);
+  ref.erase(ref.begin() + 300, ref.begin() + 450);
+  for (std::size_t step = 1; ref.size() > 20; step++) {
+    std::size_t at = next() % ref.size();
+    vec.erase(at);
+    ref.erase(ref.begin() + static_cast<std::ptrdiff_t>(at));
+    if (step % 97 == 0) {
+      vec.push_back(static_cast<int>(ref.size()));
+      ref.push_back(static_cast<int>(ref.size()));
+    }
+    ASSERT_EQ(vec.size(), ref.size());
+    for (std::size_t i = 0; i < ref.size(); i += 7) {
+      ASSERT_EQ(vec.get<int>(i), ref[i]) << "index " << i;
+    }
+  }
+  EXPECT_GT(vec.tombstones(), 900u);
+  for (std::size_t i = 0; i < ref.size(); i++) {
+    EXPECT_EQ(vec.get<int>(i), ref[i]);
+  }
+}
+
+TEST(TombstoneVectorTest, CompactsPastTheThreshold) {
+  tomb_t vec(0.25);
+  for (int i = 0; i < 100; i++) {
+    vec.push_back(std::to_string(i));
+  }
+  vec.erase(0, 20);
+  EXPECT_EQ(vec.tombstones(), 20u);
+  vec.erase(0, 6);
+  EXPECT_EQ(vec.tombstones(), 0u);
+  ASSERT_EQ(vec.size(), 74u);
+  EXPECT_EQ(vec.get<std::string>(0), "26");
+  EXPECT_EQ(vec.get<std::string>(73), "99");
+}
+
+TEST(TombstoneVectorTest, PopBackClearAndReuse) {
+  tomb_t vec;
+  for (int i = 0; i < 10; i++) {
+    vec.push_back(static_cast<char>('a' + i));
+  }
+  vec.pop_back();
+  vec.pop_back();
+  EXPECT_EQ(vec.size(), 8u);
+  EXPECT_EQ(vec.get<char>(7), 'h');
+
+  vec.push_back(std::string("new"));
+  EXPECT_EQ(vec.get<std::string>(8), "new");
+
+  vec.clear();
+  EXPECT_EQ(vec.size(), 0u);
+  EXPECT_EQ(vec.tombstones(), 0u);
+  vec.push_back(1);
+  EXPECT_EQ(vec.get<int>(0), 1);
+}
+
+// a window that slides for a long time never holds more than it should
+TEST(TombstoneVectorTest, SlidingWindow) {
+  tomb_t vec;
+  int k = 0;
+  for (int w = 0; w < 500; w++) {
+    for (int i = 0; i < 8; i++, k++) {
+      if (k % 2) {
+        vec.push_back(k);
+      } else {
+        vec.push_back(std::to_string(k));
+      }
+    }
+    if (vec.size() > 128) {
+      vec.erase(0, 8);
+    }
+    ASSERT_LE(vec.size() + vec.tombstones(), 128u * 2);
+  }
+  ASSERT_EQ(vec.size(), 128u);
+  EXPECT_EQ(vec.get<int>(127), k - 1);
+  EXPECT_EQ(vec.get<std::string>(0), std::to_string(k - 128));
+}
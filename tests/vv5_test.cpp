@@ -0,0 +1,292 @@
+#include "../include/vv4.hpp"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct Tracker {
+  static int constructions;
+  static int destructions;
+
+  Tracker() { ++constructions; }
+  Tracker(const Tracker&) { ++constructions; }
+  Tracker(Tracker&&) noexcept { ++constructions; }
+  ~Tracker() { ++destructions; }
+
+  static void reset() {
+    constructions = 0;
+    destructions = 0;
+  }
+};
+
+int Tracker::constructions = 0;
+int Tracker::destructions = 0;
+
+using vv5::Element;
+using vv5::vector;
+
+TEST(BitsTest, TagWidth) {
+  EXPECT_EQ(vv5::detail::tag_bits(1), 0u);
+  EXPECT_EQ(vv5::detail::tag_bits(2), 1u);
+  EXPECT_EQ(vv5::detail::tag_bits(3), 2u);
+  EXPECT_EQ(vv5::detail::tag_bits(4), 2u);
+  EXPECT_EQ(vv5::detail::tag_bits(5), 3u);
+  EXPECT_EQ(vv5::detail::tag_bits(256), 8u);
+}
+
+TEST(BitsTest, ReadWriteAcrossBytes) {
+  std::byte buf[4]{};
+  for (std::size_t i = 0; i < 8; i++) {
+    vv5::detail::write_bits<3>(buf, i * 3, i);
+  }
+  for (std::size_t i = 0; i < 8; i++) {
+    EXPECT_EQ(vv5::detail::read_bits<3>(buf, i * 3), i);
+  }
+  // overwrite one tag in the middle without disturbing its neighbours
+  vv5::detail::write_bits<3>(buf, 5 * 3, 0);
+  EXPECT_EQ(vv5::detail::read_bits<3>(buf, 4 * 3), 4u);
+  EXPECT_EQ(vv5::detail::read_bits<3>(buf, 5 * 3), 0u);
+  EXPECT_EQ(vv5::detail::read_bits<3>(buf, 6 * 3), 6u);
+}
+
+TEST(VectorTest, DefaultConstructor) {
+  vector<int, std::string, double> vec;
+  EXPECT_EQ(vec.size(), 0u);
+}
+
+TEST(VectorTest, PushBackDifferentTypes) {
+  vector<int, std::string, double> vec;
+
+  int a = 42;
+  vec.push_back(a);
+  EXPECT_EQ(vec.size(), 1u);
+  EXPECT_EQ(vec.get<int>(0), 42);
+
+  std::string s = "hello";
+  vec.push_back(s);
+  EXPECT_EQ(vec.size(), 2u);
+  EXPECT_EQ(vec.get<std::string>(1), "hello");
+
+  double d = 3.14;
+  vec.push_back(d);
+  EXPECT_EQ(vec.size(), 3u);
+  EXPECT_DOUBLE_EQ(vec.get<double>(2), 3.14);
+}
+
+TEST(VectorTest, AccessElementsOperator) {
+  vector<int, std::string> vec;
+  vec.push_back(100);
+  std::string hello = "world";
+  vec.push_back(hello);
+
+  Element e0 = vec[0];
+  EXPECT_EQ(e0.type_index, 0u);
+  EXPECT_EQ(*reinterpret_cast<int*>(e0.data), 100);
+
+  Element e1 = vec[1];
+  EXPECT_EQ(e1.type_index, 1u);
+  EXPECT_EQ(*reinterpret_cast<std::string*>(e1.data), "world");
+}
+
+TEST(VectorTest, SingleAlternativeNeedsNoTagBits) {
+  vector<double> vec;
+  for (int i = 0; i < 20; i++) {
+    vec.push_back(i * 0.5);
+  }
+  for (int i = 0; i < 20; i++) {
+    EXPECT_EQ(vec[i].type_index, 0u);
+    EXPECT_DOUBLE_EQ(vec.get<double>(i), i * 0.5);
+  }
+}
+
+TEST(VectorTest, FiveAlternativesPackedInThreeBits) {
+  vector<char, short, int, long long, std::string> vec;
+  for (int i = 0; i < 50; i++) {
+    switch (i % 5) {
+    case 0:
+      vec.push_back(static_cast<char>('a' + i % 26));
+      break;
+    case 1:
+      vec.push_back(static_cast<short>(i));
+      break;
+    case 2:
+      vec.push_back(i);
+      break;
+    case 3:
+      vec.push_back(static_cast<long long>(i) << 40);
+      break;
+    default:
+      vec.push_back(std::to_string(i));
+      break;
+    }
+  }
+
+  for (int i = 0; i < 50; i++) {
+    EXPECT_EQ(vec.type_index(i), static_cast<std::size_t>(i % 5));
+  }
+  EXPECT_EQ(vec.get<char>(25), static_cast<char>('a' + 25 % 26));
+  EXPECT_EQ(vec.get<short>(26), 26);
+  EXPECT_EQ(vec.get<int>(27), 27);
+  EXPECT_EQ(vec.get<long long>(28), 28ll << 40);
+  EXPECT_EQ(vec.get<std::string>(29), "29");
+}
+
+TEST(VectorTest, AlignmentRespected) {
+  vector<char, double, std::string> vec;
+  for (int i = 0; i < 30; i++) {
+    vec.push_back('x');
+    vec.push_back(static_cast<double>(i));
+    vec.push_back(std::string(40, 'y'));
+  }
+  for (std::size_t i = 0; i < vec.size(); i++) {
+    auto addr = reinterpret_cast<std::uintptr_t>(vec[i].data);
+    if (vec[i].type_index == 1) {
+      EXPECT_EQ(addr % alignof(double), 0u);
+    } else if (vec[i].type_index == 2) {
+      EXPECT_EQ(addr % alignof(std::string), 0u);
+    }
+  }
+  EXPECT_DOUBLE_EQ(vec.get<double>(88), 29.0);
+  EXPECT_EQ(vec.get<std::string>(89), std::string(40, 'y'));
+}
+
+TEST(VectorTest, CopyConstructor) {
+  vector<int, std::string> vec1;
+  vec1.push_back(10);
+  vec1.push_back(std::string("copy"));
+
+  vector<int, std::string> vec2 = vec1;
+  EXPECT_EQ(vec2.size(), 2u);
+  EXPECT_EQ(vec2.get<int>(0), 10);
+  EXPECT_EQ(vec2.get<std::string>(1), "copy");
+
+  vec2.push_back(11);
+  EXPECT_EQ(vec1.size(), 2u);
+  EXPECT_EQ(vec2.get<int>(2), 11);
+}
+
+TEST(VectorTest, MoveConstructor) {
+  vector<int, std::string> vec1;
+  vec1.push_back(20);
+  vec1.push_back(std::string("move"));
+
+  vector<int, std::string> vec2 = std::move(vec1);
+  EXPECT_EQ(vec2.size(), 2u);
+  EXPECT_EQ(vec2.get<int>(0), 20);
+  EXPECT_EQ(vec2.get<std::string>(1), "move");
+
+  EXPECT_EQ(vec1.size(), 0u);
+}
+
+TEST(VectorTest, CopyAssignment) {
+  vector<int, std::string> vec1;
+  vec1.push_back(30);
+  vec1.push_back(std::string("assign"));
+
+  vector<int, std::string> vec2;
+  vec2.push_back(std::string("old"));
+  vec2 = vec1;
+  EXPECT_EQ(vec2.size(), 2u);
+  EXPECT_EQ(vec2.get<int>(0), 30);
+  EXPECT_EQ(vec2.get<std::string>(1), "assign");
+}
+
+TEST(VectorTest, MoveAssignment) {
+  vector<int, std::string> vec1;
+  vec1.push_back(40);
+  vec1.push_back(std::string("move_assign"));
+
+  vector<int, std::string> vec2;
+  vec2.push_back(std::string("old"));
+  vec2 = std::move(vec1);
+  EXPECT_EQ(vec2.size(), 2u);
+  EXPECT_EQ(vec2.get<int>(0), 40);
+  EXPECT_EQ(vec2.get<std::string>(1), "move_assign");
+
+  EXPECT_EQ(vec1.size(), 0u);
+}
+
+TEST(VectorTest, ExceptionOnWrongTypeAccess) {
+  vector<int, std::string> vec;
+  vec.push_back(50);
+  vec.push_back(std::string("test"));
+
+  EXPECT_NO_THROW((void)vec.get<int>(0));
+  EXPECT_NO_THROW((void)vec.get<std::string>(1));
+
+  EXPECT_THROW((void)vec.get<std::string>(0), std::bad_cast);
+  EXPECT_THROW((void)vec.get<int>(1), std::bad_cast);
+}
+
+TEST(VectorTest, DestructionOfElements) {
+  Tracker::reset();
+  {
+    vector<int, Tracker> vec;
+    for (int i = 0; i < 10; i++) {
+      vec.push_back(i);
+      vec.push_back(Tracker());
+    }
+  }
+  EXPECT_EQ(Tracker::constructions, Tracker::destructions);
+}
+
+template <class Vec> void check_tag_scans(Vec& vec, std::size_t k) {
+  std::size_t n = vec.size();
+  std::size_t count = 0;
+  std::size_t first = n;
+  std::vector<std::uint64_t> mask((n + 63) / 64);
+  for (std::size_t i = 0; i < n; i++) {
+    if (vec.type_index(i) == k) {
+      count++;
+      first = std::min(first, i);
+      mask[i / 64] |= std::uint64_t{1} << (i % 64);
+    }
+  }
+  EXPECT_EQ(vec.template count_type<int>(), count) << n;
+  EXPECT_EQ(vec.template find_type<int>(), first) << n;
+  EXPECT_EQ(vec.template type_mask<int>(), mask) << n;
+  for (std::size_t from = 0; from < n; from += 3) {
+    std::size_t expected = from;
+    while (expected < n && vec.type_index(expected) != k) {
+      expected++;
+    }
+    EXPECT_EQ(vec.template find_type<int>(from), expected) << n << " " << from;
+  }
+}
+
+template <class T> struct Alt {
+  T value;
+};
+
+// 1, 2 and 4 bit tags take the word-at-a-time path, 3 bits the fallback; the
+// lengths put matches in whole words and in the tail
+TEST(VectorTest, TagScansMatchTypeIndex) {
+  for (std::size_t n : {0u, 5u, 16u, 31u, 32u, 64u, 65u, 200u}) {
+    vector<char, int> one_bit;
+    vector<char, short, int> two_bits;
+    vector<char, short, long, float, int> three_bits;
+    vector<Alt<char>, Alt<short>, Alt<long>, Alt<float>, Alt<double>,
+           Alt<bool>, Alt<unsigned>, Alt<long long>, Alt<unsigned char>, int>
+        four_bits;
+
+    for (std::size_t i = 0; i < n; i++) {
+      if (i % 5 == 2 || i % 11 == 0) {
+        one_bit.push_back(static_cast<int>(i));
+        two_bits.push_back(static_cast<int>(i));
+        three_bits.push_back(static_cast<int>(i));
+        four_bits.push_back(static_cast<int>(i));
+      } else {
+        one_bit.push_back('x');
+        two_bits.push_back(static_cast<short>(i));
+        three_bits.push_back(static_cast<float>(i));
+        four_bits.push_back(Alt<double>{1.0});
+      }
+    }
+
+    check_tag_scans(one_bit, 1);
+    check_tag_scans(two_bits, 2);
+    check_tag_scans(three_bits, 4);
+    check_tag_scans(four_bits, 9);
+  }
+}